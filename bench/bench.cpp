@@ -0,0 +1,272 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Name:        bench/bench.cpp
+// Purpose:     time each stage of a wx-flags run against generated fixtures and a stub wx-config
+// Author:      archivesilver
+// Created:     2024-08-18
+// Copyright:   (c) archivesilver
+// Licence:     wxWidgets licence
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "wxflags_internal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+using namespace wxflags;
+
+// wx-flags-bench <wx-flags> [--iterations=<n>] [--golden=<file>]
+// times createBuildCfg with setup.h parsed each time, wx-config, fixInclude, fixLibNames, fixLibs,
+// addSetupHLibs and whole runs against small, medium and large setup.h files and link lines
+// the wx-config stage runs the stub wx-config, which Windows doesn't have, so it's skipped there
+// prints the results as JSON so runs of different commits can be compared, --golden= checks the
+// outputs against a file, or writes it if it's missing, and a difference makes the exit code 1
+
+// sets environment variables for the bench and puts back what was there before
+class ScopedEnv {
+  public:
+    void set(const std::string &name, const std::string &value) {
+        const char *old = getenv(name.c_str());
+        saved.push_back({name, old ? old : "", old != nullptr});
+        put(name, value);
+    }
+    ~ScopedEnv() {
+        for(auto it = saved.rbegin(); it != saved.rend(); ++it) {
+            if(it->existed) {
+                put(it->name, it->value);
+            } else {
+#ifdef _WIN32
+                _putenv_s(it->name.c_str(), "");
+#else
+                unsetenv(it->name.c_str());
+#endif
+            }
+        }
+    }
+
+  private:
+    struct Saved {
+        std::string name, value;
+        bool existed;
+    };
+    std::vector<Saved> saved;
+    static void put(const std::string &name, const std::string &value) {
+#ifdef _WIN32
+        _putenv_s(name.c_str(), value.c_str());
+#else
+        setenv(name.c_str(), value.c_str(), 1);
+#endif
+    }
+};
+
+std::string tempDir() {
+#ifdef _WIN32
+    char path[MAX_PATH];
+    if(GetTempPath(MAX_PATH, path) == 0) return ".";
+    std::string dir = slashes(path);
+    if(dir.back() == '/') dir.pop_back();
+    return dir;
+#else
+    const char *dir = getenv("TMPDIR");
+    return dir && *dir ? dir : "/tmp";
+#endif
+}
+
+void createDirs(const std::string &path) {
+    for(size_t pos = path.find('/', 1); pos != std::string::npos; pos = path.find('/', pos + 1))
+        createDir(path.substr(0, pos));
+    createDir(path);
+}
+
+// a setup.h with every option wx-flags reads, padded with filler options
+std::string benchSetupH(int filler) {
+    std::string temp =
+        "/* lib/wx/include/msw-unicode-static-3.2/wx/setup.h. Generated by wx-flags. */\n";
+    for(const std::string &name : setupOptionNames()) {
+        temp += "\n/* " + name + " */\n";
+        temp += "#define " + name + " 1\n";
+    }
+    for(int i = 0; i < filler; i++) {
+        temp += "\n// Default is 1.\n//\n// Recommended setting: 1\n";
+        temp += "#define wxUSE_FILLER_" + std::to_string(i) + " " + std::to_string(i % 2) + "\n";
+    }
+    return temp;
+}
+
+// what wx-config prints for --cflags and --libs, with every library in all its variants
+std::string benchCFlags(const std::string &wxwin) {
+    return "-mthreads -DWXUSINGDLL -D__WXMSW__ -D_UNICODE -I" + wxwin +
+           "/lib/wx/include/msw-unicode-static-3.2 -I" + wxwin + "/include";
+}
+
+std::string benchLibs(const std::string &wxwin, int variants) {
+    const char *names[] = {"xrc", "html", "qa", "core", "adv", "aui", "propgrid", "richtext",
+                           "ribbon", "stc", "webview", "media", "gl"};
+    std::string temp = "-mthreads -L" + wxwin + "/lib/wx";
+    for(int i = 0; i < variants; i++) {
+        for(const char *name : names) {
+            temp += std::string(" -lwxmsw32u") + (i % 2 ? "d_" : "_") + name;
+        }
+        temp += i % 2 ? " -lwxbase32ud_xml -lwxbase32ud_net -lwxbase32ud" :
+                        " -lwxbase32u_xml -lwxbase32u_net -lwxbase32u";
+    }
+    return temp + " -lwxscintilla -lwxregexu -lwxexpat -lwxzlib -lwxpng -lwxjpeg -lwxtiff";
+}
+
+// mean time per call of a stage in nanoseconds
+template <typename Stage> long long timeStage(int iterations, Stage stage) {
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < iterations; i++) stage();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / iterations;
+}
+
+int main(int argc, char *argv[]) {
+    if(argc < 2) {
+        std::cerr << "usage: wx-flags-bench <wx-flags> [--iterations=<n>] [--golden=<file>]"
+                  << std::endl;
+        return 2;
+    }
+    std::string self = argv[1], golden = "", root = tempDir() + "/wx-flags-bench";
+    int iterations = 200;
+    for(int i = 2; i < argc; i++) {
+        if(strncmp(argv[i], "--iterations=", 13) == 0)
+            iterations = std::max(1, atoi(argv[i] + 13));
+        else if(strncmp(argv[i], "--golden=", 9) == 0)
+            golden = argv[i] + 9;
+    }
+    int spawns = std::max(5, iterations / 20);
+    std::string bin = root + "/bin", outputs = "",
+                json = "{\"iterations\": " + std::to_string(iterations) + ", \"fixtures\": [";
+    createDirs(bin);
+    ScopedEnv env;
+#ifndef _WIN32
+    // the stub answers like wx-config-win would, PATH finds it before the real one
+    std::string stub = "#!/bin/sh\nout=\"\"\nfor a in \"$@\"; do case \"$a\" in\n"
+                       "  --cflags) out=\"$out $(cat \"$WXWIN/cflags\")\";;\n"
+                       "  --libs) out=\"$out $(cat \"$WXWIN/libs\")\";;\n"
+                       "esac; done\necho $out\n";
+    writeFileAtomic(bin + "/wx-config", stub);
+    chmod((bin + "/wx-config").c_str(), 0755);
+    const char *path = getenv("PATH");
+    env.set("PATH", bin + ":" + (path ? path : ""));
+#endif
+    // the runs must not find a server
+    env.set("WXFLAGS_SOCKET", root + "/no-server");
+    // nor a compiler, build.cfg gets the same values on every machine
+    env.set("CXX", root + "/no-compiler");
+    struct Fixture {
+        const char *name;
+        int filler, variants;
+    } fixtures[] = {{"small", 0, 1}, {"medium", 500, 4}, {"large", 5000, 16}};
+    for(const Fixture &fixture : fixtures) {
+        Build build;
+        build.wxwin = root + "/" + fixture.name + "/build";
+        build.wxcfg = "wx/include/msw-unicode-static-3.2";
+        const std::string &wxwin = build.wxwin;
+        createDirs(cfgDir(build) + "/wx");
+        std::string setuph = benchSetupH(fixture.filler), cflags = benchCFlags(wxwin),
+                    libs = benchLibs(wxwin, fixture.variants), version = wxVersion(build);
+        writeFileIfChanged(cfgDir(build) + "/wx/setup.h", setuph);
+        writeFileIfChanged(wxwin + "/cflags", cflags);
+        writeFileIfChanged(wxwin + "/libs", libs);
+        // the stub and the whole runs read them, the stages get the build
+        ScopedEnv fixtureEnv;
+        fixtureEnv.set("WXWIN", wxwin);
+        fixtureEnv.set("WXCFG", build.wxcfg);
+
+        // each stage the way a first run goes through it, build.cfg and the saved setup.h
+        // model are removed so setup.h is parsed every time
+        std::string buildCfg = cfgDir(build) + "/build.cfg",
+                    model = cacheDir(build) + "/setup.model", result;
+        long long createTime = timeStage(iterations, [&] {
+            remove(buildCfg.c_str());
+            remove(model.c_str());
+            forgetSetupModels();
+            createBuildCfg(build);
+        });
+        long long spawnTime = 0;
+#ifndef _WIN32
+        int status;
+        spawnTime = timeStage(
+            spawns, [&] { result = wxconfig(build, "wx-config --cflags --libs", status); });
+#endif
+        long long includeTime = timeStage(iterations, [&] { result = fixInclude(cflags); }),
+                  namesTime = timeStage(iterations, [&] { result = fixLibNames(libs, version); }),
+                  libsTime = timeStage(iterations, [&] { result = fixLibs(build, libs, false); }),
+                  setupTime = timeStage(iterations, [&] { result = addSetupHLibs(build); });
+        // whole runs, without and with the cache
+        std::string run = "\"" + self + "\" --cflags --libs";
+        ProcessResult process;
+        auto invoke = [&](const std::string &extra) {
+            process = runProcess(run + extra, [&](std::string_view chunk) { result.append(chunk); },
+                                 build.timeout);
+        };
+        result = "";
+        long long coldTime = timeStage(spawns, [&] { invoke(" --wxflagsNOCACHE"); }),
+                  cachedTime = timeStage(spawns, [&] { invoke(""); });
+
+        // the outputs, with the fixture folder taken out so the file is the same everywhere
+        std::string out = "== " + std::string(fixture.name) + "\n";
+        std::string cfg;
+        readFile(buildCfg, cfg);
+        result = "";
+        invoke(" --wxflagsNOCACHE");
+        out += "build.cfg:\n" + cfg + "fixInclude: " + fixInclude(cflags) +
+               "\nfixLibNames: " + fixLibNames(libs, version) +
+               "\nfixLibs: " + fixLibs(build, libs, false) +
+               "addSetupHLibs: " + addSetupHLibs(build) + "\nrun: " + result;
+        for(size_t pos = out.find(wxwin); pos != std::string::npos; pos = out.find(wxwin, pos))
+            out.replace(pos, wxwin.length(), "WXWIN");
+        for(size_t pos = out.find(root); pos != std::string::npos; pos = out.find(root, pos))
+            out.replace(pos, root.length(), "ROOT");
+        outputs += out;
+
+        auto perSecond = [](long long nanoseconds) {
+            return std::to_string(nanoseconds > 0 ? 1000000000LL / nanoseconds : 0);
+        };
+        if(json.back() == '}') json += ", ";
+        json += "{\"name\": \"" + std::string(fixture.name) +
+                "\", \"setup_h_bytes\": " + std::to_string(setuph.size()) +
+                ", \"link_line_bytes\": " + std::to_string(libs.size()) +
+                ", \"ns_per_call\": {\"createBuildCfg\": " + std::to_string(createTime) +
+                ", \"wxconfig\": " + std::to_string(spawnTime) +
+                ", \"fixInclude\": " + std::to_string(includeTime) +
+                ", \"fixLibNames\": " + std::to_string(namesTime) +
+                ", \"fixLibs\": " + std::to_string(libsTime) +
+                ", \"addSetupHLibs\": " + std::to_string(setupTime) +
+                "}, \"invocations_per_second\": " + perSecond(coldTime) +
+                ", \"cached_invocations_per_second\": " + perSecond(cachedTime) + "}";
+    }
+    json += "]";
+    int status = 0;
+    if(golden != "") {
+        std::string expected;
+        if(!readFile(golden, expected)) {
+            writeFileAtomic(golden, outputs);
+            json += ", \"golden\": \"written\"";
+        } else if(expected == outputs) {
+            json += ", \"golden\": \"match\"";
+        } else {
+            // the first line that differs is usually enough to see what changed
+            std::istringstream was(expected), is(outputs);
+            std::string before, after;
+            while(std::getline(was, before) && std::getline(is, after) && before == after) {
+            }
+            std::cerr << "Golden output differs:\n- " << before << "\n+ " << after << std::endl;
+            json += ", \"golden\": \"differ\"";
+            status = 1;
+        }
+    }
+    std::cout << json << "}" << std::endl;
+    return status;
+}
@@ -0,0 +1,215 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Name:        bench/headers.cpp
+// Purpose:     count the file lookups of preprocessing a wx source with and without a header map
+// Author:      archivesilver
+// Created:     2024-08-18
+// Copyright:   (c) archivesilver
+// Licence:     wxWidgets licence
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "wxflags_internal.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <sys/stat.h>
+#include <vector>
+
+using namespace wxflags;
+
+// wx-flags-headers-bench [--repeats=<n>]
+// generates a wx include tree and a source that includes wx/wx.h like a typical wx program,
+// then follows its includes the way the preprocessor does with the include folders as
+// wx-config gives them, after --wxflagsMININCLUDE and with the --wxflagsHEADERS=hmap map
+// every stat() counts as a lookup, the folders of the system headers are left out as they are
+// the same for all three, and the results are printed as JSON
+// the exit code is 1 if the header map doesn't find the same files with fewer lookups
+// with the tree of about 300 headers generated here that is 3213, 2007 and 1207 lookups
+
+std::string benchRoot() {
+    const char *dir = getenv("TMPDIR");
+#ifdef _WIN32
+    if(!dir || !*dir) dir = getenv("TEMP");
+#endif
+    return std::string(dir && *dir ? dir : "/tmp") + "/wx-flags-headers-bench";
+}
+
+void createDirs(const std::string &path) {
+    for(size_t pos = path.find('/', 1); pos != std::string::npos; pos = path.find('/', pos + 1))
+        createDir(path.substr(0, pos));
+    createDir(path);
+}
+
+// headers that include each other like wx's do: every one includes wx/defs.h and some system
+// headers, the common ones include their port, wx/wx.h includes the common ones
+void writeTree(const std::string &include, const std::string &setupDir) {
+    const char *ports[] = {"msw", "generic", "private"};
+    const char *system[] = {"stddef.h", "string.h", "windows.h", "commctrl.h"};
+    std::string all = "#include <wx/defs.h>\n";
+    createDirs(setupDir + "/wx");
+    writeFileIfChanged(setupDir + "/wx/setup.h", "#define wxUSE_GUI 1\n");
+    createDirs(include + "/wx");
+    writeFileIfChanged(include + "/wx/defs.h", "#include <wx/setup.h>\n#include <stddef.h>\n");
+    for(const char *port : ports) createDirs(include + "/wx/" + std::string(port));
+    for(int i = 0; i < 200; i++) {
+        std::string name = "wx/header" + std::to_string(i) + ".h";
+        std::string temp = "#include <wx/defs.h>\n#include <" + std::string(system[i % 4]) + ">\n";
+        if(i > 0) temp += "#include <wx/header" + std::to_string(i - 1) + ".h>\n";
+        if(i % 2 == 0) {
+            std::string port = "wx/" + std::string(ports[i % 3]) + "/header" + std::to_string(i) +
+                               ".h";
+            temp += "#include <" + port + ">\n";
+            writeFileIfChanged(include + "/" + port, "#include <wx/defs.h>\n");
+        }
+        writeFileIfChanged(include + "/" + name, temp);
+        all += "#include <" + name + ">\n";
+    }
+    writeFileIfChanged(include + "/wx/wx.h", all);
+}
+
+// the folders of the -I flags in order
+std::vector<std::string> includeDirs(const std::string &flags) {
+    std::vector<std::string> dirs;
+    size_t pos = 0;
+    while((pos = flags.find("-I", pos)) != std::string::npos) {
+        size_t end = flags.find_first_of(" \n", pos);
+        dirs.push_back(flags.substr(pos + 2, end - pos - 2));
+        pos = end;
+    }
+    return dirs;
+}
+
+// clang's lookup in a header map, "" if the name isn't in it
+std::string mapLookup(const std::string &map, const std::string &name) {
+    auto get = [&](size_t offset) {
+        const unsigned char *p = (const unsigned char *)map.data() + offset;
+        return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+    };
+    if(map.size() < 24) return "";
+    uint32_t strings = get(8), buckets = get(16), hash = 0;
+    for(char c : name) hash += tolower((unsigned char)c) * 13;
+    auto text = [&](uint32_t offset) { return std::string(map.c_str() + strings + offset); };
+    for(uint32_t i = 0; i < buckets; i++) {
+        size_t bucket = 24 + ((hash + i) & (buckets - 1)) * 12;
+        if(get(bucket) == 0) return "";
+        std::string key = text(get(bucket));
+        if(key.size() == name.size() &&
+           std::equal(key.begin(), key.end(), name.begin(), [](char a, char b) {
+               return tolower((unsigned char)a) == tolower((unsigned char)b);
+           }))
+            return text(get(bucket + 4)) + text(get(bucket + 8));
+    }
+    return "";
+}
+
+struct Preprocessor {
+    std::vector<std::string> dirs;
+    std::string map;
+    long long lookups = 0;
+    std::set<std::string> found; // the files the includes resolved to
+
+    bool exists(const std::string &filename) {
+        lookups++;
+        struct stat info;
+        return stat(filename.c_str(), &info) == 0 && !(info.st_mode & S_IFDIR);
+    }
+
+    // the header map first, then each folder until one has the header
+    std::string find(const std::string &name) {
+        if(map != "") {
+            std::string mapped = mapLookup(map, name);
+            if(mapped != "" && exists(mapped)) return mapped;
+        }
+        for(const std::string &dir : dirs) {
+            if(exists(dir + "/" + name)) return dir + "/" + name;
+        }
+        return "";
+    }
+
+    // every #include <...> is looked up, even of headers that were read before
+    void run(const std::string &filename) {
+        std::string text;
+        if(!readFile(filename, text)) return;
+        size_t pos = 0;
+        while((pos = text.find("#include <", pos)) != std::string::npos) {
+            pos += 10;
+            std::string name = text.substr(pos, text.find('>', pos) - pos);
+            std::string file = find(name);
+            if(file != "" && found.insert(file).second) run(file);
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    int repeats = 5;
+    for(int i = 1; i < argc; i++) {
+        if(strncmp(argv[i], "--repeats=", 10) == 0) repeats = std::max(1, atoi(argv[i] + 10));
+    }
+    // WXWIN is the build folder, the headers are next to it
+    std::string root = benchRoot(), wxwin = root + "/wxWidgets-3.2.5/build",
+                setupDir = wxwin + "/lib/wx/include/msw-unicode-static-3.2";
+    writeTree(root + "/wxWidgets-3.2.5/include", setupDir);
+    writeFileIfChanged(root + "/app.cpp", "#include <wx/wx.h>\n#include <string.h>\n");
+    // what wx-config gives, with a folder that doesn't exist and the include folder twice
+    std::string flags = fixInclude("-mthreads -D__WXMSW__ -D_UNICODE -I" + wxwin +
+                                   "/contrib/include -I" + setupDir + " -I" + wxwin +
+                                   "/include -I" + wxwin + "/include\n");
+    std::string minimal = minimizeIncludes(flags);
+    std::string map = headerMap(wxHeaders(minimal));
+    writeFileIfChanged(root + "/wx.hmap", map);
+
+    struct Mode {
+        const char *name;
+        std::string flags;
+        bool map;
+    } modes[] = {{"wx-config", flags, false}, {"mininclude", minimal, false},
+                 {"hmap", minimal, true}};
+    std::set<std::string> expected;
+    long long plain = 0, mapped = 0;
+    int status = 0;
+    std::string json = "{\"repeats\": " + std::to_string(repeats) + ", \"modes\": [";
+    for(const Mode &mode : modes) {
+        Preprocessor preprocessor;
+        long long best = -1;
+        for(int i = 0; i < repeats; i++) {
+            preprocessor = Preprocessor();
+            preprocessor.dirs = includeDirs(mode.flags);
+            auto start = std::chrono::steady_clock::now();
+            // clang reads the map once for a source
+            if(mode.map) {
+                preprocessor.lookups++;
+                readFile(root + "/wx.hmap", preprocessor.map);
+            }
+            preprocessor.run(root + "/app.cpp");
+            long long elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now() - start)
+                                    .count();
+            if(best < 0 || elapsed < best) best = elapsed;
+        }
+        if(expected.empty()) expected = preprocessor.found;
+        if(preprocessor.found != expected) {
+            std::cerr << mode.name << " finds other headers than wx-config's folders" << std::endl;
+            status = 1;
+        }
+        if(mode.map)
+            mapped = preprocessor.lookups;
+        else if(plain == 0)
+            plain = preprocessor.lookups;
+        if(json.back() == '}') json += ", ";
+        json += "{\"name\": \"" + std::string(mode.name) +
+                "\", \"include_dirs\": " + std::to_string(preprocessor.dirs.size()) +
+                ", \"headers\": " + std::to_string(preprocessor.found.size()) +
+                ", \"lookups\": " + std::to_string(preprocessor.lookups) +
+                ", \"ns\": " + std::to_string(best) + "}";
+    }
+    if(mapped >= plain) {
+        std::cerr << "The header map takes " << mapped << " lookups, without it " << plain
+                  << std::endl;
+        status = 1;
+    }
+    std::cout << json << "]}" << std::endl;
+    return status;
+}
@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Name:        bench/rewrite.cpp
+// Purpose:     check that rewriting wx-config's output takes time linear in its length
+// Author:      archivesilver
+// Created:     2024-08-18
+// Copyright:   (c) archivesilver
+// Licence:     wxWidgets licence
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "wxflags_internal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+
+using namespace wxflags;
+
+// wx-flags-rewrite-bench [--repeats=<n>] [--limit=<ratio>]
+// rewrites link lines and include flags from 2 KB to 512 KB and prints the time per byte as JSON
+// the exit code is 1 if a byte of the longest line costs more than limit times one of an 8 KB
+// line, which a rewrite that copies the string for every match can't stay under
+
+// a link line of about size bytes with every kind of token the rules look at
+std::string linkLine(size_t size) {
+    const char *names[] = {"xrc", "html", "core", "adv", "aui", "propgrid", "ribbon", "stc"};
+    std::string temp = "-mthreads -LC:/wxWidgets-3.2.5/lib/wx";
+    for(int i = 0; temp.size() < size; i++) {
+        temp += std::string(" -lwxmsw32u") + (i % 2 ? "d_" : "_") + names[i % 8];
+        if(i % 8 == 7) temp += " -lwxbase32u_xml -lwxscintilla -lwxregexu -Wl,--as-needed";
+    }
+    return temp + "\n";
+}
+
+std::string includeLine(size_t size) {
+    std::string temp = "-mthreads -DWXUSINGDLL -D__WXMSW__";
+    for(int i = 0; temp.size() < size; i++) {
+        temp += " -IC:/wxWidgets-3.2.5/lib/wx/include/msw-unicode-static-3.2 -D_UNICODE -I" +
+                std::string("C:/wxWidgets-3.2.5/include/") + std::to_string(i);
+    }
+    return temp + "\n";
+}
+
+// the best of repeats runs in nanoseconds per byte, the best one has the least noise
+double perByte(int repeats, size_t bytes, const std::function<void()> &stage) {
+    long long best = -1;
+    for(int i = 0; i < repeats; i++) {
+        auto start = std::chrono::steady_clock::now();
+        stage();
+        long long elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now() - start)
+                                .count();
+        if(best < 0 || elapsed < best) best = elapsed;
+    }
+    return double(best) / bytes;
+}
+
+int main(int argc, char *argv[]) {
+    int repeats = 20;
+    double limit = 4;
+    for(int i = 1; i < argc; i++) {
+        if(strncmp(argv[i], "--repeats=", 10) == 0)
+            repeats = std::max(1, atoi(argv[i] + 10));
+        else if(strncmp(argv[i], "--limit=", 8) == 0)
+            limit = atof(argv[i] + 8);
+    }
+    struct Stage {
+        const char *name;
+        std::function<std::string(const std::string &)> rewrite;
+        std::function<std::string(size_t)> line;
+    } stages[] = {
+        {"fixInclude", [](const std::string &str) { return fixInclude(str); }, includeLine},
+        {"fixLibNames", [](const std::string &str) { return fixLibNames(str, "3.2"); }, linkLine},
+        {"fixLibs", [](const std::string &str) { return fixLibs(str, "-lz -lpng", "3.2"); },
+         linkLine},
+    };
+    const size_t smallest = 2048, reference = 8192, largest = 512 * 1024;
+    int status = 0;
+    std::string json = "{\"repeats\": " + std::to_string(repeats) + ", \"stages\": [";
+    for(const Stage &stage : stages) {
+        double referenceCost = 0, largestCost = 0;
+        std::string sizes = "";
+        for(size_t size = smallest; size <= largest; size *= 2) {
+            std::string line = stage.line(size), result;
+            double cost = perByte(repeats, line.size(), [&] { result = stage.rewrite(line); });
+            if(size == reference) referenceCost = cost;
+            if(size == largest) largestCost = cost;
+            if(sizes != "") sizes += ", ";
+            sizes += "\"" + std::to_string(line.size()) + "\": " + std::to_string(cost);
+        }
+        double ratio = referenceCost > 0 ? largestCost / referenceCost : 0;
+        if(ratio > limit) {
+            std::cerr << stage.name << " isn't linear: a byte of " << largest << " costs " << ratio
+                      << " times one of " << reference << std::endl;
+            status = 1;
+        }
+        if(json.back() == '}') json += ", ";
+        json += "{\"name\": \"" + std::string(stage.name) + "\", \"ns_per_byte\": {" + sizes +
+                "}, \"ratio\": " + std::to_string(ratio) + "}";
+    }
+    std::cout << json << "]}" << std::endl;
+    return status;
+}
@@ -0,0 +1,21 @@
+# sourced by the tests: a scratch copy of the fixture tree with the stub wx-config first on PATH,
+# no server and no compiler, so every run sees the same files and writes only to the copy
+wxflags=$1 compiler=$3
+fixtures=$(cd "$(dirname "$0")/fixtures" && pwd) || exit 1
+root=$(mktemp -d "${TMPDIR:-/tmp}/wx-flags-test.XXXXXX")
+trap 'rm -rf "$root"' EXIT
+cp -R "$fixtures/." "$root"
+export PATH="$root/bin:$PATH"
+export WXWIN="$root/wxWidgets-3.2.5/build" WXCFG=wx/include/msw-unicode-static-3.2
+export WXFLAGS_SOCKET="$root/no-server" CXX="$root/no-compiler"
+unset WXFLAGS_TRACE WXFLAGS_TEST_CALLS WXFLAGS_TEST_DELAY WXFLAGS_TEST_EXIT WXFLAGS_TEST_LIBS
+
+fail() {
+    echo "FAIL: $*" >&2
+    exit 1
+}
+
+# an expected output with the scratch folder filled in
+expected() {
+    sed "s|@ROOT@|$root|g" "$root/expected/$1"
+}
@@ -0,0 +1,37 @@
+# many invocations at once, as under make -j, run wx-config once and all get the same answer
+. "$(dirname "$0")/common.sh"
+count=200
+
+# a process killed while it holds the lock doesn't block the ones after it
+WXFLAGS_TEST_DELAY=5 "$wxflags" --cflags --libs > /dev/null 2>&1 &
+sleep 1
+kill -9 $! 2> /dev/null
+wait $! 2> /dev/null
+
+export WXFLAGS_TEST_CALLS="$root/calls" WXFLAGS_TEST_DELAY=1 WXFLAGS_CACHESTATS=1
+i=0
+while [ $i -lt $count ]; do
+    "$wxflags" --cflags --libs > "$root/out.$i" 2> "$root/err.$i" &
+    i=$((i + 1))
+done
+wait
+
+[ "$(wc -l < "$root/calls")" -eq 1 ] ||
+    fail "wx-config ran more than once: $(wc -l < "$root/calls") times"
+i=0
+while [ $i -lt $count ]; do
+    [ -s "$root/err.$i" ] && fail "invocation $i failed: $(cat "$root/err.$i")"
+    cmp -s "$root/out.0" "$root/out.$i" || fail "invocation $i gave a different answer"
+    i=$((i + 1))
+done
+{ expected cflags; expected libs; } | tr '\n' ' ' | tr -s ' ' > "$root/want"
+tr '\n' ' ' < "$root/out.0" | tr -s ' ' | cmp -s "$root/want" - ||
+    fail "the shared answer is wrong: $(cat "$root/out.0")"
+
+# every run was counted once, and the counters stay two numbers
+"$wxflags" --wxflagsCACHESTATS > "$root/stats" || fail "--wxflagsCACHESTATS failed"
+grep -q "^hits: $((count - 1)) misses: 1 " "$root/stats" ||
+    fail "the counters lost runs: $(cat "$root/stats")"
+[ "$(wc -c < "$WXWIN/lib/$WXCFG/wx-flags-cache/stats")" -lt 16 ] ||
+    fail "the stats file grows with every run"
+exit 0
@@ -0,0 +1,54 @@
+/* lib/wx/include/msw-unicode-static-3.2/wx/setup.h.  Generated from setup.h.in by configure.  */
+
+/* a trimmed setup.h of a static MSW build, with the options wx-flags reads */
+
+#ifndef __WX_SETUP_H__
+#define __WX_SETUP_H__
+
+#define wxUSE_UNICODE 1
+
+#define wxUSE_EXCEPTIONS 1
+
+#define wxUSE_THREADS 1
+
+#define wxUSE_GUI 1
+
+#define wxUSE_AUI 1
+
+#define wxUSE_AUI_NOTEBOOK 0
+
+#define wxUSE_HTML 1
+
+#define wxUSE_MEDIACTRL 0
+
+#define wxUSE_OPENGL 0
+
+#define wxUSE_PROPGRID 1
+
+#define wxUSE_RIBBON 0
+
+#define wxUSE_RICHTEXT 0
+
+#define wxUSE_STC 1
+
+#define wxUSE_WEBVIEW 0
+
+#define wxUSE_XRC 1
+
+#define wxUSE_XML wxUSE_XRC
+
+#define wxUSE_GRAPHICS_CONTEXT 1
+
+#define wxUSE_LIBJPEG 1
+
+#define wxUSE_LIBPNG 1
+
+#define wxUSE_LIBTIFF 0
+
+#define wxUSE_OLE 1
+
+#define wxUSE_SOCKETS 1
+
+#define wxUSE_ZLIB 1
+
+#endif /* __WX_SETUP_H__ */
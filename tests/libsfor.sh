@@ -0,0 +1,17 @@
+# --wxflagsLIBSFOR= and --wxflagsORDER read COFF objects, both the regular and the bigobj header
+# fixtures/coff was built from C with gcc -c and objcopy -O pe-x86-64 or pe-bigobj-x86-64:
+# app.obj calls coreThing, core (bigobj) defines it and calls htmlThing, html (regular) defines it
+. "$(dirname "$0")/common.sh"
+cp "$root/coff/"*.a "$WXWIN/lib" || fail "couldn't copy the archives"
+
+# wx-config lists html first, only the bigobj member says core needs it
+"$wxflags" --libs --wxflagsORDER > "$root/out" 2> "$root/err" || fail "ordering failed"
+grep -q -- "-lwx_mswu_core-3.2 .*-lwx_mswu_html-3.2" "$root/out" ||
+    fail "core isn't before html: $(cat "$root/out")"
+
+"$wxflags" --libs --wxflagsLIBSFOR="$root/coff/app.obj" > "$root/out" 2> "$root/err" ||
+    fail "--wxflagsLIBSFOR= failed: $(cat "$root/err")"
+grep -q -- "-lwx_mswu_core-3.2" "$root/out" || fail "the regular object's library was dropped"
+grep -q -- "-lwx_mswu_html-3.2" "$root/out" || fail "the bigobj member's library was dropped"
+grep -q -- "-lwx_mswu_qa-3.2" "$root/out" && fail "an unused library was kept: $(cat "$root/out")"
+exit 0
@@ -0,0 +1,40 @@
+# native mode gives the flags the rewritten wx-config output has, without starting wx-config
+. "$(dirname "$0")/common.sh"
+export WXFLAGS_TEST_CALLS="$root/calls"
+
+for category in cflags rcflags libs; do
+    "$wxflags" --$category --wxflagsNATIVE --wxflagsNOCACHE > "$root/out" ||
+        fail "native --$category failed"
+    expected $category | cmp -s - "$root/out" ||
+        fail "native --$category differs: $(cat "$root/out")"
+done
+[ -s "$root/calls" ] && fail "native mode ran wx-config: $(cat "$root/calls")"
+
+for category in cflags rcflags libs; do
+    "$wxflags" --$category --wxflagsNOCACHE > "$root/out" || fail "--$category failed"
+    expected $category | cmp -s - "$root/out" || fail "--$category differs: $(cat "$root/out")"
+done
+
+# the shared build, wx-config adds WXUSINGDLL there
+for route in --wxflagsNATIVE ""; do
+    "$wxflags" --cflags $route --wxflagsNOCACHE --wxcfg=wx/include/msw-unicode-3.2 > "$root/out" ||
+        fail "shared --cflags $route failed"
+    expected cflags-shared | cmp -s - "$root/out" ||
+        fail "shared --cflags $route differs: $(cat "$root/out")"
+done
+
+# a build with other components, compared against wx-config by the tool itself
+setuph="$WXWIN/lib/$WXCFG/wx/setup.h"
+sed -e 's/wxUSE_STC 1/wxUSE_STC 0/' -e 's/wxUSE_RIBBON 0/wxUSE_RIBBON 1/' \
+    -e 's/wxUSE_OLE 1/wxUSE_OLE 0/' "$setuph" > "$setuph.new"
+mv "$setuph.new" "$setuph"
+# the last definition of an option wins, either definition of GRAPHICS_CONTEXT enables it
+printf '#define wxUSE_LIBPNG 0\n#define wxUSE_GRAPHICS_CONTEXT 0\n' >> "$setuph"
+"$wxflags" --libs --wxflagsNATIVE --wxflagsNOCACHE > "$root/out" || fail "native --libs failed"
+grep -q -- "-lpng" "$root/out" && fail "an option redefined to 0 is still enabled"
+grep -q -- "-lgdiplus" "$root/out" || fail "GRAPHICS_CONTEXT redefined to 0 was disabled"
+"$wxflags" --cflags --rcflags --libs --wxflagsVERIFY > "$root/out" ||
+    fail "native flags differ from wx-config: $(cat "$root/out")"
+"$wxflags" --libs --wxflagsNATIVE --wxflagsNOCACHE | grep -q -- "-lwx_mswu_ribbon-3.2" ||
+    fail "native --libs didn't follow setup.h"
+exit 0
@@ -0,0 +1,47 @@
+# --wxflagsORDER moves only the wx libraries, and cached answers follow the archives
+. "$(dirname "$0")/common.sh"
+lib="$WXWIN/lib"
+
+# an archive defining a function and calling another one
+archive() {
+    echo "int $2(); int $3() { return $2(); }" > "$root/$1.cpp"
+    "$compiler" -c "$root/$1.cpp" -o "$root/$1.o" || fail "couldn't compile $1"
+    rm -f "$lib/lib$1-3.2.a"
+    ar rcs "$lib/lib$1-3.2.a" "$root/$1.o" || fail "couldn't archive $1"
+}
+
+# core needs html, so it has to come first, the flags between the libraries stay there
+archive wx_mswu_core htmlThing coreThing
+archive wx_mswu_html otherThing htmlThing
+export WXFLAGS_TEST_LIBS=-Wl,--as-needed
+"$wxflags" --libs --wxflagsORDER > "$root/out" || fail "ordering failed"
+grep -q -- "-L[^ ]* -lwx_[^ ]* -lwx_[^ ]* -Wl,--as-needed -lwx_" "$root/out" ||
+    fail "-Wl,--as-needed moved: $(cat "$root/out")"
+grep -q -- "-lwx_mswu_core-3.2 .*-lwx_mswu_html-3.2" "$root/out" ||
+    fail "core isn't before html: $(cat "$root/out")"
+
+# the other way around, the cached answer must not be used
+archive wx_mswu_core otherThing coreThing
+archive wx_mswu_html coreThing htmlThing
+"$wxflags" --libs --wxflagsORDER > "$root/out" || fail "ordering failed"
+grep -q -- "-lwx_mswu_html-3.2 .*-lwx_mswu_core-3.2" "$root/out" ||
+    fail "a rebuilt archive gave the cached order: $(cat "$root/out")"
+
+# native answers drop the archives that aren't there
+"$wxflags" --libs --wxflagsNATIVE | grep -q -- "-lwx_mswu_qa-3.2" || fail "native --libs failed"
+rm "$lib/libwx_mswu_qa-3.2.a"
+"$wxflags" --libs --wxflagsNATIVE | grep -q -- "-lwx_mswu_qa-3.2" &&
+    fail "a removed archive is still in the cached native answer"
+
+# two cycles get a group each, --wxflagsCANONICAL keeps both and the flags between libraries
+archive wx_mswu_core htmlThing coreThing
+archive wx_mswu_html coreThing htmlThing
+archive wx_mswu_aui propgridThing auiThing
+archive wx_mswu_propgrid auiThing propgridThing
+"$wxflags" --libs --wxflagsORDER --wxflagsCANONICAL > "$root/out" || fail "canonical ordering failed"
+[ "$(grep -o -- "-Wl,--start-group" "$root/out" | wc -l)" -eq 2 ] &&
+    [ "$(grep -o -- "-Wl,--end-group" "$root/out" | wc -l)" -eq 2 ] ||
+    fail "a group of a cycle was lost: $(cat "$root/out")"
+[ "$(grep -o -- "-Wl,--as-needed" "$root/out" | wc -l)" -eq 1 ] ||
+    fail "-Wl,--as-needed was lost: $(cat "$root/out")"
+exit 0
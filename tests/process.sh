@@ -0,0 +1,48 @@
+# wx-config's exit status, its errors and a timeout reach the caller, and its output is rewritten
+. "$(dirname "$0")/common.sh"
+
+"$wxflags" --cflags --wxflagsNOCACHE > "$root/out" 2> "$root/err" || fail "a plain query failed"
+expected cflags | cmp -s - "$root/out" || fail "the --cflags output changed: $(cat "$root/out")"
+
+WXFLAGS_TEST_EXIT=3 "$wxflags" --libs --wxflagsNOCACHE > "$root/out" 2> "$root/err"
+[ $? -eq 3 ] || fail "the exit status of wx-config was lost"
+grep -q "failing on purpose" "$root/err" || fail "the errors of wx-config were lost"
+grep -q "failing on purpose" "$root/out" && fail "the errors of wx-config ended up in the flags"
+
+start=$(date +%s)
+WXFLAGS_TEST_DELAY=10 "$wxflags" --cflags --wxflagsNOCACHE --wxflagsTIMEOUT=1 > /dev/null 2> "$root/err" &&
+    fail "a wx-config that didn't finish counted as success"
+[ $(($(date +%s) - start)) -lt 8 ] || fail "the timeout didn't stop wx-config"
+grep -q "didn't finish" "$root/err" || fail "the timeout wasn't reported"
+
+# build.cfg is checked while wx-config runs, which only runs again if build.cfg changed
+cfg="$WXWIN/lib/$WXCFG"
+"$wxflags" --libs --wxflagsNOCACHE > /dev/null || fail "a plain query failed"
+touch "$cfg/wx/setup.h"
+WXFLAGS_TEST_CALLS="$root/calls.touched" "$wxflags" --libs --wxflagsNOCACHE > /dev/null ||
+    fail "a query after touching setup.h failed"
+[ "$(wc -l < "$root/calls.touched")" -eq 1 ] || fail "an unchanged build.cfg ran wx-config again"
+sed 's/wxUSE_RIBBON 0/wxUSE_RIBBON 1/' "$cfg/wx/setup.h" > "$cfg/wx/setup.h.new"
+mv "$cfg/wx/setup.h.new" "$cfg/wx/setup.h"
+WXFLAGS_TEST_CALLS="$root/calls.changed" "$wxflags" --libs --wxflagsNOCACHE 2> "$root/err" |
+    grep -q -- "-lwx_mswu_ribbon-3.2" || fail "a changed setup.h wasn't followed"
+[ "$(wc -l < "$root/calls.changed")" -eq 2 ] || fail "a changed build.cfg didn't run wx-config again"
+grep -q "^USE_RIBBON=1" "$cfg/build.cfg" || fail "build.cfg didn't follow setup.h"
+
+# response files go to the working folder or the given one, the cache folder is the fallback
+mkdir "$root/project" && cd "$root/project" || fail "no project folder"
+rsp=$("$wxflags" --libs --wxflagsRSP) || fail "--wxflagsRSP failed"
+case "$rsp" in @wx-*.rsp) ;; *) fail "the response file isn't in the working folder: $rsp" ;; esac
+[ -f "${rsp#@}" ] || fail "$rsp wasn't written"
+rsp=$("$wxflags" --libs --wxflagsRSP="$root/rsp") || fail "--wxflagsRSP=<dir> failed"
+[ "$(dirname "${rsp#@}")" = "$root/rsp" ] && [ -f "${rsp#@}" ] ||
+    fail "the response file isn't in the given folder: $rsp"
+touch "$root/not-a-folder"
+rsp=$("$wxflags" --libs --wxflagsRSP="$root/not-a-folder") || fail "the fallback failed"
+[ "$(dirname "${rsp#@}")" = "$cfg/wx-flags-cache" ] || fail "no fallback to the cache: $rsp"
+
+# --wxflagsALL cleans up --prefix= the way a single query does
+"$wxflags" --cflags --wxflagsALL --prefix="$WXWIN/ " > "$root/out" 2> "$root/err" ||
+    fail "--wxflagsALL with a trailing slash failed: $(cat "$root/err")"
+grep -q "^$WXCFG  *0 " "$root/out" || fail "--wxflagsALL missed the configuration: $(cat "$root/out")"
+exit 0
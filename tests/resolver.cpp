@@ -0,0 +1,56 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Name:        tests/resolver.cpp
+// Purpose:     the in-process Resolver follows setup.h changes like the command does
+// Author:      archivesilver
+// Created:     2024-08-18
+// Copyright:   (c) archivesilver
+// Licence:     wxWidgets licence
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "wxflags.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// run by resolver.sh, which points WXWIN and WXCFG at a scratch copy of the fixture tree
+int fail(const std::string &message) {
+    std::cerr << "FAIL: " << message << std::endl;
+    return 1;
+}
+
+std::string readFile(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary);
+    std::ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+void replace(std::string &text, const std::string &from, const std::string &to) {
+    size_t pos = text.find(from);
+    if(pos != std::string::npos) text.replace(pos, from.length(), to);
+}
+
+int main() {
+    std::string cfg = std::string(getenv("WXWIN")) + "/lib/" + getenv("WXCFG"),
+                setuph = cfg + "/wx/setup.h";
+    wxflags::Resolver resolver;
+    wxflags::Config config;
+    std::shared_ptr<const wxflags::Result> result = resolver.query(config, {wxflags::LIBS});
+    if(result->status != 0) return fail("the first query failed");
+    if(result->libs.find("-lwx_mswu_ribbon-3.2") != std::string::npos)
+        return fail("ribbon is linked before setup.h asks for it");
+
+    // the same resolver, so the parsed setup.h of the first query is still around
+    std::string text = readFile(setuph);
+    replace(text, "wxUSE_RIBBON 0", "wxUSE_RIBBON 1");
+    std::ofstream(setuph, std::ios::binary) << text;
+    result = resolver.query(config, {wxflags::LIBS});
+    if(result->status != 0) return fail("the query after the change failed");
+    if(result->libs.find("-lwx_mswu_ribbon-3.2") == std::string::npos)
+        return fail("the changed setup.h was ignored: " + result->libs);
+    if(readFile(cfg + "/build.cfg").find("USE_RIBBON=1") == std::string::npos)
+        return fail("build.cfg has the old setup.h:\n" + readFile(cfg + "/build.cfg"));
+    return 0;
+}
@@ -0,0 +1,4 @@
+# the library remembers parsed setup.h files, a change is still seen by the next query
+. "$(dirname "$0")/common.sh"
+"$2" || exit 1
+exit 0
@@ -0,0 +1,84 @@
+# a running server answers like a separate run would, from wherever the client runs
+. "$(dirname "$0")/common.sh"
+servers=""
+trap 'kill $servers 2> /dev/null; rm -rf "$root"' EXIT
+
+# start a server in its own folder with its own log of wx-config calls
+# the environment of the call is the server's
+start() {
+    mkdir -p "$root/$1"
+    (cd "$root/$1" && exec env WXFLAGS_TEST_CALLS="$root/$1/calls" WXFLAGS_SOCKET="$root/$1.sock" \
+        "$wxflags" --wxflagsSERVE) 2> "$root/$1/err" &
+    servers="$servers $!"
+    i=0
+    while [ ! -S "$root/$1.sock" ]; do
+        i=$((i + 1))
+        [ $i -lt 100 ] || fail "the server in $1 didn't start: $(cat "$root/$1/err")"
+        sleep 0.1
+    done
+}
+
+start server
+export WXFLAGS_SOCKET="$root/server.sock" WXFLAGS_TEST_CALLS="$root/client-calls"
+
+# a relative --prefix= means the client's folder, not the server's
+mkdir "$root/elsewhere"
+(cd "$root/elsewhere" && unset WXWIN &&
+    "$wxflags" --cflags --prefix=../wxWidgets-3.2.5/build > "$root/out" 2> "$root/err") ||
+    fail "a query with a relative --prefix= failed: $(cat "$root/err")"
+expected cflags | cmp -s - "$root/out" || fail "relative --prefix= gave: $(cat "$root/out")"
+[ -s "$root/server/calls" ] || fail "the server didn't answer"
+[ -e "$root/client-calls" ] && fail "the client ran wx-config itself"
+
+# the server forgets answers when setup.h changes
+"$wxflags" --libs > "$root/out" || fail "--libs failed"
+setuph="$WXWIN/lib/$WXCFG/wx/setup.h"
+sed 's/wxUSE_RIBBON 0/wxUSE_RIBBON 1/' "$setuph" > "$setuph.new"
+mv "$setuph.new" "$setuph"
+sleep 0.2
+"$wxflags" --libs | grep -q -- "-lwx_mswu_ribbon-3.2" || fail "the server kept an answer for the old setup.h"
+
+# the server answers response file queries, the client writes the file in its own folder
+(cd "$root/elsewhere" && "$wxflags" --libs --wxflagsRSP="$root/elsewhere/rsp" > "$root/out") ||
+    fail "a response file query failed"
+[ -f "$(sed 's/^@//' "$root/out")" ] || fail "the response file isn't where the client is"
+[ -e "$root/client-calls" ] && fail "the client ran wx-config for --wxflagsRSP="
+
+# the server runs wx-config with the client's WXCFG and finds it on the client's PATH
+WXCFG=wx/include/msw-unicode-3.2 "$wxflags" --cflags > "$root/out" || fail "a shared query failed"
+expected cflags-shared | cmp -s - "$root/out" ||
+    fail "the client's WXCFG was lost: $(cat "$root/out")"
+mkdir "$root/other"
+printf '#!/bin/sh\necho "$("%s" "$@") -DOTHER_WX_CONFIG"\n' "$root/bin/wx-config" \
+    > "$root/other/wx-config"
+chmod +x "$root/other/wx-config"
+PATH="$root/other:$PATH" "$wxflags" --cflags | grep -q -- -DOTHER_WX_CONFIG ||
+    fail "the server didn't use the wx-config on the client's PATH"
+"$wxflags" --cflags | grep -q -- -DOTHER_WX_CONFIG && fail "the answer for another PATH was reused"
+
+# clients are answered side by side, the same query still runs wx-config once
+WXFLAGS_TEST_DELAY=2 start slow
+started=$(date +%s) clients=""
+for query in --cflags --libs --rcflags --rcflags; do
+    WXFLAGS_SOCKET="$root/slow.sock" "$wxflags" $query > /dev/null &
+    clients="$clients $!"
+done
+wait $clients
+[ $(($(date +%s) - started)) -lt 4 ] || fail "the server answered one client after another"
+[ "$(grep -c rcflags "$root/slow/calls")" -eq 1 ] || fail "the same query ran wx-config twice"
+[ -e "$root/client-calls" ] && fail "the client ran wx-config itself"
+
+# errors and the exit status of wx-config on the server reach the client
+WXFLAGS_TEST_EXIT=3 start failing
+WXFLAGS_SOCKET="$root/failing.sock" "$wxflags" --cflags > "$root/out" 2> "$root/err"
+[ $? -eq 3 ] || fail "the exit status of wx-config on the server was lost"
+grep -q "failing on purpose" "$root/err" || fail "the errors of wx-config on the server were lost"
+[ -e "$root/client-calls" ] && fail "the client ran wx-config itself"
+
+# the default socket is only used in a folder of this user's that nobody else can get into
+mkdir "$root/runtime"
+chmod 755 "$root/runtime"
+XDG_RUNTIME_DIR="$root/runtime" WXFLAGS_SOCKET= "$wxflags" --wxflagsSERVE 2> "$root/err" &&
+    fail "the server listened in a folder others can get into"
+grep -q "No folder" "$root/err" || fail "the unsafe folder wasn't reported: $(cat "$root/err")"
+exit 0
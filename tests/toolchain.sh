@@ -0,0 +1,47 @@
+# build.cfg and --wxflagsFASTLINK answers follow the compiler, and the build type of the query
+. "$(dirname "$0")/common.sh"
+cfg="$WXWIN/lib/$WXCFG/build.cfg"
+
+# a compiler that takes every option, mold only while $CXX.mold exists, and logs its calls
+export CXX="$root/bin/fake-clang++"
+cat > "$CXX" << 'END'
+#!/bin/sh
+echo "$*" >> "$0.calls"
+case "$*" in *--version*) echo "clang version $(cat "$0.version")"; exit 0 ;; esac
+case "$*" in *-fuse-ld=mold*) [ -e "$0.mold" ] || exit 1 ;; esac
+exit 0
+END
+chmod +x "$CXX"
+echo 17.0.1 > "$CXX.version"
+touch "$CXX.mold"
+
+"$wxflags" --libs --wxflagsFASTLINK > "$root/out" || fail "a fast link query failed"
+grep -q -- "-fuse-ld=mold" "$root/out" || fail "mold wasn't used: $(cat "$root/out")"
+grep -q "^COMPILER_VERSION=17.0.1" "$cfg" || fail "build.cfg has another compiler: $(cat "$cfg")"
+grep -q -- "-flto=thin -Wl,--thinlto-cache-dir=" "$root/out" ||
+    fail "the ThinLTO cache came without ThinLTO: $(cat "$root/out")"
+
+# another compiler, rewritten so its stamp changes
+rm "$CXX.mold"
+echo 18.1.0 > "$CXX.version"
+cp "$CXX" "$CXX.new" && mv "$CXX.new" "$CXX"
+# other queries don't look for the compiler
+rm "$CXX.calls"
+"$wxflags" --cflags --libs > /dev/null || fail "a plain query failed"
+[ -e "$CXX.calls" ] && fail "a plain query probed the compiler: $(cat "$CXX.calls")"
+grep -q "^COMPILER_VERSION=17.0.1" "$cfg" || fail "a plain query updated build.cfg"
+"$wxflags" --libs --wxflagsFASTLINK > "$root/out" || fail "a fast link query failed"
+grep -q -- "-fuse-ld=lld" "$root/out" || fail "the cached mold answer came back: $(cat "$root/out")"
+grep -q "^COMPILER_VERSION=18.1.0" "$cfg" || fail "build.cfg didn't follow the compiler"
+
+# wx-config's --debug= decides between split DWARF and --gc-sections, BUILD of build.cfg
+# when the query has none
+grep -q "^BUILD=debug" "$cfg" || fail "build.cfg changed its BUILD: $(cat "$cfg")"
+"$wxflags" --cflags --libs --wxflagsFASTLINK > "$root/out" || fail "a fast link query failed"
+grep -q -- "-gsplit-dwarf" "$root/out" || fail "a debug build got no split DWARF"
+grep -q -- "-Wl,--gc-sections" "$root/out" && fail "a debug build got --gc-sections"
+"$wxflags" --cflags --libs --debug=no --wxflagsFASTLINK > "$root/out" ||
+    fail "a release fast link query failed"
+grep -q -- "-Wl,--gc-sections" "$root/out" || fail "--debug=no has no --gc-sections"
+grep -q -- "-gsplit-dwarf" "$root/out" && fail "--debug=no got split DWARF"
+exit 0
@@ -0,0 +1,4445 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Name:        wxflags.cpp
+// Purpose:     make wx-config work with modern static wxWidgets libraries on Windows,
+//              the library behind the wx-flags command
+// Author:      archivesilver
+// Created:     2024-08-18
+// Copyright:   (c) archivesilver
+// Licence:     wxWidgets licence
+////////////////////////////////////////////////////////////////////////////////////////////////////
+ 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/file.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char **environ;
+#endif
+
+#include "wxflags.h"
+#include "wxflags_internal.h"
+
+namespace wxflags {
+
+bool fileExists(const std::string &filename) {
+#ifdef _WIN32
+    DWORD attributes = GetFileAttributes(filename.c_str());
+    return (attributes != INVALID_FILE_ATTRIBUTES && !(attributes & FILE_ATTRIBUTE_DIRECTORY));
+#else
+    struct stat info;
+    return stat(filename.c_str(), &info) == 0 && !S_ISDIR(info.st_mode);
+#endif
+}
+
+bool dirExists(const std::string &dir) {
+#ifdef _WIN32
+    DWORD attributes = GetFileAttributes(dir.c_str());
+    return (attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY));
+#else
+    struct stat info;
+    return stat(dir.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+}
+
+void strstrip(std::string &str) {
+    int size = str.length(), begin = 0;
+    if(size <= 0) return;
+    while(size > 0 && isspace(str[size - 1])) size--;
+    while(size > begin && isspace(str[begin])) begin++;
+    // erase in place so the buffer is kept
+    str.erase(size);
+    str.erase(0, begin);
+}
+
+// fix WXWIN and WXCFG
+void fixWXvars(Build &build) {
+    std::string &wxwin = build.wxwin, &wxcfg = build.wxcfg;
+    strstrip(wxwin);
+    if(wxwin != "" && (wxwin.back() == '/' || wxwin.back() == '\\')) wxwin.pop_back();
+    strstrip(wxcfg);
+    if(wxcfg != "" && (wxcfg.back() == '/' || wxcfg.back() == '\\')) wxcfg.pop_back();
+    if(wxcfg != "" && (wxcfg[0] == '/' || wxcfg[0] == '\\')) wxcfg.erase(0, 1);
+}
+
+// fill what the command line didn't give from the environment variables
+// returns false if WXWIN or WXCFG is still missing
+bool getWXvars(Build &build) {
+    if(build.wxwin == "" && getenv("WXWIN")) build.wxwin = getenv("WXWIN");
+    if(build.wxcfg == "" && getenv("WXCFG")) build.wxcfg = getenv("WXCFG");
+    fixWXvars(build);
+    return build.wxwin != "" && build.wxcfg != "";
+}
+
+std::string toUpperCase(const std::string &str) {
+    std::string upperStr = str;
+#ifdef _WIN32
+    CharUpperBuffA(&upperStr[0], upperStr.length()); // Modify inplace
+#else
+    for(char &c : upperStr) c = toupper((unsigned char)c);
+#endif
+    return upperStr;
+}
+
+std::string toLowerCase(const std::string &str) {
+    std::string lowerStr = str;
+#ifdef _WIN32
+    CharLowerBuffA(&lowerStr[0], lowerStr.length()); // Modify inplace
+#else
+    for(char &c : lowerStr) c = tolower((unsigned char)c);
+#endif
+    return lowerStr;
+}
+
+// 64-bit FNV-1a, good enough to name cache files
+uint64_t fnv1a(const std::string &str) {
+    uint64_t hash = 14695981039346656037ULL;
+    for(unsigned char c : str) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string toHex(uint64_t value) {
+    const char *digits = "0123456789abcdef";
+    std::string hex(16, '0');
+    for(int i = 15; i >= 0; i--, value >>= 4) hex[i] = digits[value & 0xf];
+    return hex;
+}
+
+// size and modification time of a file, "-" if it doesn't exist
+std::string fileStamp(const std::string &filename) {
+    std::ostringstream stamp;
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if(filename == "" || !GetFileAttributesEx(filename.c_str(), GetFileExInfoStandard, &data))
+        return "-";
+    stamp << data.nFileSizeHigh << ":" << data.nFileSizeLow << ":"
+          << data.ftLastWriteTime.dwHighDateTime << ":" << data.ftLastWriteTime.dwLowDateTime;
+#else
+    struct stat info;
+    if(filename == "" || stat(filename.c_str(), &info) != 0) return "-";
+    stamp << info.st_size << ":" << info.st_mtim.tv_sec << ":" << info.st_mtim.tv_nsec;
+#endif
+    return stamp.str();
+}
+
+// the entry for a variable in a build's environment, nullptr if it has none
+const std::string *findVariable(const std::vector<std::string> &environment,
+                                const std::string &name) {
+    for(const std::string &variable : environment) {
+        if(variable.length() < name.length() ||
+           (variable.length() > name.length() && variable[name.length()] != '='))
+            continue;
+#ifdef _WIN32
+        // names are case insensitive here, PATH is often Path
+        if(toLowerCase(variable.substr(0, name.length())) == toLowerCase(name)) return &variable;
+#else
+        if(variable.compare(0, name.length(), name) == 0) return &variable;
+#endif
+    }
+    return nullptr;
+}
+
+// a variable as the programs of a query see it, nullptr if it's unset
+const char *getBuildEnv(const std::vector<std::string> &environment, const std::string &name) {
+    const std::string *variable = findVariable(environment, name);
+    if(!variable) return getenv(name.c_str());
+    return variable->length() > name.length() ? variable->c_str() + name.length() + 1 : nullptr;
+}
+
+// find an executable the same way the process runner would
+std::string findProgram(const std::string &name, const std::vector<std::string> &environment = {}) {
+#ifdef _WIN32
+    // SearchPath() looks through this process's PATH unless it gets another
+    const std::string *variable = findVariable(environment, "PATH");
+    const char *dirs = variable ? getBuildEnv(environment, "PATH") : NULL;
+    char path[MAX_PATH];
+    if(SearchPath(variable ? (dirs ? dirs : "") : NULL, name.c_str(), ".exe", MAX_PATH, path,
+                  NULL) == 0)
+        return "";
+    return path;
+#else
+    const char *path = getBuildEnv(environment, "PATH");
+    std::istringstream dirs(path ? path : "");
+    std::string dir;
+    while(std::getline(dirs, dir, ':')) {
+        std::string candidate = (dir == "" ? "." : dir) + "/" + name;
+        if(access(candidate.c_str(), X_OK) == 0) return candidate;
+    }
+    return "";
+#endif
+}
+
+std::string findWxConfig(const Build &build) {
+    return findProgram("wx-config", build.environment);
+}
+
+int processId() {
+#ifdef _WIN32
+    return GetCurrentProcessId();
+#else
+    return getpid();
+#endif
+}
+
+void createDir(const std::string &dir) {
+#ifdef _WIN32
+    CreateDirectory(dir.c_str(), NULL);
+#else
+    mkdir(dir.c_str(), 0777);
+#endif
+}
+
+// write to a temporary file and move it over the target so readers never see half a file
+bool writeFileAtomic(const std::string &filename, const std::string &content) {
+    std::string temp = filename + "." + std::to_string(processId()) + ".tmp";
+    std::ofstream outfile(temp, std::ios::binary);
+    if(!outfile) return false;
+    outfile << content;
+    outfile.close();
+#ifdef _WIN32
+    if(!outfile || !MoveFileEx(temp.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+#else
+    if(!outfile || rename(temp.c_str(), filename.c_str()) != 0) {
+#endif
+        remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+// an exclusive lock on a file for concurrent runs, held until it goes out of scope
+// the system drops it when its process ends, so a crashed run can't leave a stale lock behind
+// gives up after the wx-config timeout, the work is then simply done twice
+struct FileLock {
+#ifdef _WIN32
+    HANDLE file;
+#else
+    int file;
+#endif
+    bool locked = false;
+
+    // gives up after timeout ms, the work is then done without the lock
+    FileLock(const std::string &filename, int timeout) {
+        std::chrono::steady_clock::time_point deadline =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+#ifdef _WIN32
+        file = CreateFile(filename.c_str(), GENERIC_READ | GENERIC_WRITE,
+                          FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_ALWAYS,
+                          FILE_ATTRIBUTE_NORMAL, NULL);
+        if(file == INVALID_HANDLE_VALUE) return;
+        OVERLAPPED overlapped = {};
+        while(!(locked = LockFileEx(file, LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY, 0, 1,
+                                    0, &overlapped)) &&
+              std::chrono::steady_clock::now() < deadline)
+            Sleep(5);
+#else
+        file = open(filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+        if(file < 0) return;
+        while(!(locked = flock(file, LOCK_EX | LOCK_NB) == 0) &&
+              std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+#endif
+    }
+    ~FileLock() {
+#ifdef _WIN32
+        if(file == INVALID_HANDLE_VALUE) return;
+        OVERLAPPED overlapped = {};
+        if(locked) UnlockFileEx(file, 0, 1, 0, &overlapped);
+        CloseHandle(file);
+#else
+        // closing releases the lock
+        if(file >= 0) close(file);
+#endif
+    }
+};
+
+// --wxflagsTRACE[=<file>] or WXFLAGS_TRACE=<file> records where the time goes as Chrome trace
+// events, for chrome://tracing or ui.perfetto.dev, everything below is skipped while it's off
+bool tracing = false;
+std::string traceFile; // stderr when empty
+std::vector<std::string> traceEvents;
+std::mutex traceLock;
+
+// what the stages did, only counted while tracing
+struct TraceCounters {
+    std::atomic<long long> bytesRead{0}, linesScanned{0}, processes{0}, reallocations{0};
+} traceCounters;
+
+inline void traceCount(std::atomic<long long> &counter, long long amount) {
+    if(tracing) counter += amount;
+}
+
+// microseconds since the epoch, so the events of concurrent runs line up
+long long traceClock() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+// small thread numbers read better in the viewer than the system's
+int traceThread() {
+    static std::atomic<int> threads{0};
+    thread_local int id = ++threads;
+    return id;
+}
+
+void traceEvent(const std::string &name, char phase, long long ts, const std::string &rest) {
+    std::string event = "{\"name\":\"" + name + "\",\"cat\":\"wx-flags\",\"ph\":\"" +
+                        std::string(1, phase) + "\",\"ts\":" + std::to_string(ts) +
+                        ",\"pid\":" + std::to_string(processId()) +
+                        ",\"tid\":" + std::to_string(traceThread()) + rest + "}";
+    std::lock_guard<std::mutex> lock(traceLock);
+    traceEvents.push_back(event);
+}
+
+// the counters so far, as a counter event the viewer draws as a graph
+void traceCounterEvent() {
+    traceEvent("counters", 'C', traceClock(),
+               ",\"args\":{\"bytes read\":" + std::to_string(traceCounters.bytesRead) +
+                   ",\"lines scanned\":" + std::to_string(traceCounters.linesScanned) +
+                   ",\"processes\":" + std::to_string(traceCounters.processes) +
+                   ",\"reallocations\":" + std::to_string(traceCounters.reallocations) + "}");
+}
+
+// times the rest of the enclosing block
+struct TraceScope {
+    const char *name;
+    long long start = 0;
+
+    explicit TraceScope(const char *name) : name(tracing ? name : NULL) {
+        if(this->name) start = traceClock();
+    }
+    ~TraceScope() {
+        if(!name) return;
+        traceEvent(name, 'X', start, ",\"dur\":" + std::to_string(traceClock() - start));
+        traceCounterEvent();
+    }
+};
+
+void startTrace(int argc, char *argv[]) {
+    const char *env = getenv("WXFLAGS_TRACE");
+    if(env && *env) {
+        tracing = true;
+        traceFile = env;
+    }
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg == "--wxflagsTRACE") {
+            tracing = true;
+        } else if(arg.rfind("--wxflagsTRACE=", 0) == 0) {
+            tracing = true;
+            traceFile = arg.substr(15);
+        }
+    }
+    if(!tracing) return;
+    // concurrent runs tell themselves apart by their arguments
+    std::string command;
+    for(int i = 1; i < argc; i++) {
+        for(const char *c = argv[i]; *c; c++) {
+            if(*c == '"' || *c == '\\') command += '\\';
+            command += *c;
+        }
+        command += " ";
+    }
+    traceEvent("process_name", 'M', 0, ",\"args\":{\"name\":\"wx-flags " + command + "\"}");
+}
+
+// trace files are a JSON array without its closing bracket, which the viewers accept,
+// so every run can append its events with one write that other runs can't split
+void appendTrace(const std::string &filename, const std::string &events) {
+    if(!fileExists(filename)) {
+        // the file comes into existence with its bracket, a run appending at the same time
+        // can't get its events in front of it
+        std::string temp = filename + "." + std::to_string(processId()) + ".tmp";
+        std::ofstream(temp, std::ios::binary) << "[\n";
+#ifdef _WIN32
+        MoveFileEx(temp.c_str(), filename.c_str(), 0);
+#else
+        if(link(temp.c_str(), filename.c_str()) != 0 && errno != EEXIST)
+            std::cerr << "Error: Could not create " << filename << std::endl;
+#endif
+        remove(temp.c_str());
+    }
+#ifdef _WIN32
+    HANDLE file = CreateFile(filename.c_str(), FILE_APPEND_DATA,
+                             FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                             OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    DWORD written = 0;
+    if(file == INVALID_HANDLE_VALUE ||
+       !WriteFile(file, events.data(), (DWORD)events.size(), &written, NULL))
+        std::cerr << "Error: Could not write " << filename << std::endl;
+    if(file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+    int file = open(filename.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0666);
+    if(file < 0 || write(file, events.data(), events.size()) != (ssize_t)events.size())
+        std::cerr << "Error: Could not write " << filename << std::endl;
+    if(file >= 0) close(file);
+#endif
+}
+
+void finishTrace() {
+    if(!tracing) return;
+    std::lock_guard<std::mutex> lock(traceLock);
+    std::string events;
+    for(const std::string &event : traceEvents) events += event + ",\n";
+    if(traceFile != "") {
+        appendTrace(traceFile, events);
+    } else if(events != "") {
+        // a complete array on its own
+        events.erase(events.size() - 2);
+        std::cerr << "[\n" << events << "\n]" << std::endl;
+    }
+}
+
+// read a whole file at once
+bool readFile(const std::string &filename, std::string &content) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if(!file.is_open()) return false;
+    content.resize(file.tellg());
+    file.seekg(0);
+    traceCount(traceCounters.bytesRead, content.size());
+    return bool(file.read(&content[0], content.size()));
+}
+
+// only write when the content changes, so build tools don't see a new mtime
+// returns false if the file couldn't be written
+bool writeFileIfChanged(const std::string &filename, const std::string &content) {
+    std::string current;
+    if(readFile(filename, current) && current == content) return true;
+    return writeFileAtomic(filename, content);
+}
+
+// the folder with build.cfg, setup.h is in its wx subfolder
+std::string cfgDir(const Build &build) { return build.wxwin + "/lib/" + build.wxcfg; }
+
+// results are cached next to build.cfg, one file per query
+std::string cacheDir(const Build &build) { return cfgDir(build) + "/wx-flags-cache"; }
+
+// the setup.h options wx-flags reads, -1 if setup.h doesn't define them
+struct SetupModel {
+    bool loaded = false;
+    std::string version; // from the comment on the first line
+    int unicode = -1, exceptions = -1, threads = -1, gui = -1, aui = -1, html = -1,
+        mediactrl = -1, opengl = -1, propgrid = -1, ribbon = -1, richtext = -1, stc = -1,
+        webview = -1, xrc = -1, xml = -1, graphicsContext = -1, libjpeg = -1, libpng = -1,
+        libtiff = -1, ole = -1, sockets = -1, zlib = -1;
+};
+
+// exact option names, sorted for binary search
+const struct SetupOption {
+    const char *name;
+    int SetupModel::*value;
+    bool anyEnables = false; // defined more than once, either of them being 1 enables it
+} setupOptions[] = {
+    {"wxUSE_AUI", &SetupModel::aui},
+    {"wxUSE_EXCEPTIONS", &SetupModel::exceptions},
+    {"wxUSE_GRAPHICS_CONTEXT", &SetupModel::graphicsContext, true},
+    {"wxUSE_GUI", &SetupModel::gui},
+    {"wxUSE_HTML", &SetupModel::html},
+    {"wxUSE_LIBJPEG", &SetupModel::libjpeg},
+    {"wxUSE_LIBPNG", &SetupModel::libpng},
+    {"wxUSE_LIBTIFF", &SetupModel::libtiff},
+    {"wxUSE_MEDIACTRL", &SetupModel::mediactrl},
+    {"wxUSE_OLE", &SetupModel::ole},
+    {"wxUSE_OPENGL", &SetupModel::opengl},
+    {"wxUSE_PROPGRID", &SetupModel::propgrid},
+    {"wxUSE_RIBBON", &SetupModel::ribbon},
+    {"wxUSE_RICHTEXT", &SetupModel::richtext},
+    {"wxUSE_SOCKETS", &SetupModel::sockets},
+    {"wxUSE_STC", &SetupModel::stc},
+    {"wxUSE_THREADS", &SetupModel::threads},
+    {"wxUSE_UNICODE", &SetupModel::unicode},
+    {"wxUSE_WEBVIEW", &SetupModel::webview},
+    {"wxUSE_XML", &SetupModel::xml, true},
+    {"wxUSE_XRC", &SetupModel::xrc, true},
+    {"wxUSE_ZLIB", &SetupModel::zlib},
+};
+
+const SetupOption *findSetupOption(std::string_view name) {
+    const SetupOption *end = setupOptions + sizeof(setupOptions) / sizeof(setupOptions[0]);
+    const SetupOption *option = std::lower_bound(
+        setupOptions, end, name,
+        [](const SetupOption &option, std::string_view name) { return option.name < name; });
+    if(option == end || option->name != name) return nullptr;
+    return option;
+}
+
+std::vector<std::string> setupOptionNames() {
+    std::vector<std::string> names;
+    for(const SetupOption &option : setupOptions) names.push_back(option.name);
+    return names;
+}
+
+// read-only view of a whole file
+struct MappedFile {
+    const char *data = nullptr;
+    size_t size = 0;
+    bool open = false;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE, mapping = NULL;
+
+    explicit MappedFile(const std::string &filename) {
+        file = CreateFile(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                          OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        LARGE_INTEGER fileSize;
+        if(file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize)) return;
+        open = true;
+        // empty files can't be mapped
+        if(fileSize.QuadPart == 0) return;
+        mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if(mapping) data = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if(data) {
+            size = fileSize.QuadPart;
+        } else {
+            open = false;
+        }
+    }
+    ~MappedFile() {
+        if(data) UnmapViewOfFile(data);
+        if(mapping) CloseHandle(mapping);
+        if(file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    }
+#else
+    explicit MappedFile(const std::string &filename) {
+        int file = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat info;
+        if(file < 0) return;
+        if(fstat(file, &info) == 0) {
+            open = true;
+            // empty files can't be mapped
+            if(info.st_size > 0) {
+                void *view = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+                if(view != MAP_FAILED) {
+                    data = static_cast<const char *>(view);
+                    size = info.st_size;
+                } else {
+                    open = false;
+                }
+            }
+        }
+        close(file);
+    }
+    ~MappedFile() {
+        if(data) munmap(const_cast<char *>(data), size);
+    }
+#endif
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+};
+
+bool isNameChar(char c) { return isalnum((unsigned char)c) || c == '_'; }
+
+// "#define wxUSE_X value", anything else is ignored
+void parseSetupLine(std::string_view line, SetupModel &model) {
+    size_t pos = line.find_first_not_of(" \t");
+    if(pos == std::string_view::npos || line[pos] != '#') return;
+    pos = line.find_first_not_of(" \t", pos + 1);
+    if(pos == std::string_view::npos || line.compare(pos, 6, "define") != 0) return;
+    pos = line.find_first_not_of(" \t", pos + 6);
+    if(pos == std::string_view::npos) return;
+    size_t end = pos;
+    while(end < line.size() && isNameChar(line[end])) end++;
+    const SetupOption *option = findSetupOption(line.substr(pos, end - pos));
+    if(!option) return;
+    pos = line.find_first_not_of(" \t", end);
+    if(pos == std::string_view::npos) return;
+    end = pos;
+    while(end < line.size() && isNameChar(line[end])) end++;
+    std::string_view token = line.substr(pos, end - pos);
+    int value = -1;
+    if(token.size() > 0 && isdigit((unsigned char)token[0])) {
+        value = atoi(std::string(token).c_str());
+    } else if(const SetupOption *other = findSetupOption(token)) {
+        // defined as another option
+        value = model.*other->value;
+    }
+    // the last definition wins, like one inside a platform #if, except for the options
+    // where either definition counts
+    if(value < 0) return;
+    if(!option->anyEnables || value > model.*option->value) model.*option->value = value;
+}
+
+// read setup.h in a single pass
+void parseSetupH(std::string_view text, SetupModel &model) {
+    size_t begin = 0, lines = 0;
+    while(begin < text.size()) {
+        lines++;
+        size_t end = text.find('\n', begin);
+        if(end == std::string_view::npos) end = text.size();
+        std::string_view line = text.substr(begin, end - begin);
+        begin = end + 1;
+        // technically reading the first line, which is a comment
+        if(model.version == "") {
+            size_t pos = line.find("wx\\setup.h");
+            if(pos == std::string_view::npos) pos = line.find("wx/setup.h");
+            size_t pos2 = pos == std::string_view::npos ? pos : line.rfind("-", pos);
+            if(pos2 != std::string_view::npos) {
+                model.version = std::string(line.substr(pos2 + 1, pos - pos2 - 2));
+                continue;
+            }
+        }
+        parseSetupLine(line, model);
+    }
+    traceCount(traceCounters.linesScanned, lines);
+}
+
+// changes when setup.h is read differently, so models saved before are parsed again
+const std::string setupModelFormat = "model2 ";
+
+// the parsed model is saved with the stamp of the setup.h it came from
+bool readSetupModel(const std::string &filename, const std::string &stamp, SetupModel &model) {
+    std::ifstream file(filename);
+    std::string line;
+    if(!std::getline(file, line) || line != setupModelFormat + stamp) return false;
+    while(std::getline(file, line)) {
+        size_t pos = line.find("=");
+        if(pos == std::string::npos) continue;
+        std::string name = line.substr(0, pos), value = line.substr(pos + 1);
+        if(name == "version") {
+            model.version = value;
+        } else if(const SetupOption *option = findSetupOption(name)) {
+            model.*option->value = atoi(value.c_str());
+        }
+    }
+    model.loaded = true;
+    return true;
+}
+
+void writeSetupModel(const Build &build, const std::string &filename, const std::string &stamp,
+                     const SetupModel &model) {
+    std::string content = setupModelFormat + stamp + "\nversion=" + model.version + "\n";
+    for(const SetupOption &option : setupOptions)
+        content += std::string(option.name) + "=" + std::to_string(model.*option.value) + "\n";
+    createDir(cacheDir(build));
+    writeFileAtomic(filename, content);
+}
+
+SetupModel loadSetupModel(const Build &build, const std::string &stamp) {
+    std::string setuph = cfgDir(build) + "/wx/setup.h", saved = cacheDir(build) + "/setup.model";
+    SetupModel model;
+    if(stamp == "-") return model;
+    if(readSetupModel(saved, stamp, model)) return model;
+    MappedFile file(setuph);
+    if(!file.open) return model;
+    traceCount(traceCounters.bytesRead, file.size);
+    parseSetupH(std::string_view(file.data, file.size), model);
+    model.loaded = true;
+    writeSetupModel(build, saved, stamp, model);
+    return model;
+}
+
+// a parsed model and the stamp of the setup.h it came from
+struct LoadedSetup {
+    std::string stamp;
+    SetupModel model;
+};
+
+// parsed models by configuration, replaced when the stamp of setup.h changes
+std::map<std::string, LoadedSetup> setupModels;
+std::mutex setupModelsLock;
+
+// setup.h is only parsed again when it changed, a copy is returned as another thread can
+// replace the model meanwhile
+SetupModel setupModel(const Build &build) {
+    std::string key = build.wxwin + "\n" + build.wxcfg,
+                stamp = fileStamp(cfgDir(build) + "/wx/setup.h");
+    {
+        std::lock_guard<std::mutex> lock(setupModelsLock);
+        std::map<std::string, LoadedSetup>::iterator found = setupModels.find(key);
+        if(found != setupModels.end() && found->second.stamp == stamp) return found->second.model;
+    }
+    // other configurations can load theirs meanwhile
+    SetupModel model = loadSetupModel(build, stamp);
+    std::lock_guard<std::mutex> lock(setupModelsLock);
+    setupModels[key] = LoadedSetup{stamp, model};
+    return model;
+}
+
+// drop the parsed models, the next setupModel() reads setup.model or setup.h again
+void forgetSetupModels() {
+    std::lock_guard<std::mutex> lock(setupModelsLock);
+    setupModels.clear();
+}
+
+// x.y.z of a wxWidgets-x.y.z folder in WXWIN, "" if it isn't in one
+std::string folderVersion(const std::string &wxwin) {
+    std::string wxWidgets = "wxWidgets-", ver = "";
+    size_t pos = wxwin.rfind(wxWidgets), pos2;
+    if(pos != std::string::npos) {
+        pos2 = wxwin.find("\\", pos);
+        if(pos2 == std::string::npos) pos2 = wxwin.find("/", pos);
+        ver = wxwin.substr(pos + wxWidgets.length(), pos2 - pos - wxWidgets.length());
+    }
+    return ver.length() >= 5 ? ver : "";
+}
+
+// the version library names end in, hoping WXWIN includes it, then from setup.h
+// 3.2 is the current and the fallback version
+std::string wxVersion(const Build &build) {
+    std::string ver = folderVersion(build.wxwin);
+    if(ver != "") return ver.substr(0, ver.rfind("."));
+    SetupModel setup = setupModel(build);
+    return setup.version.length() >= 3 ? setup.version : "3.2";
+}
+
+// what the compiler builds use can do, the defaults are what build.cfg used to guess
+struct Toolchain {
+    std::string compiler = "clang", version, cc = "cc", cxx = "c++";
+    bool lld = false, mold = false, gcSections = false, thinLto = false, splitDwarf = false;
+};
+
+// probed further down, next to the process runner
+const Toolchain &toolchain(const Build &build);
+std::string toolchainIdentity(const Build &build);
+
+// build.cfg value of a setup.h option
+std::string setupValue(int value) {
+    if(value < 0) return "";
+    return value > 0 ? "1" : "0";
+}
+
+// the lines of build.cfg as wx-flags would write them
+// returns false if setup.h can't be read
+bool generateBuildCfg(const Build &build, std::vector<std::string> &lines) {
+    std::string setuph = cfgDir(build) + "/wx/setup.h";
+    size_t pos, pos2;
+    std::string config[39] = {
+        "WXVER_MAJOR=",      "WXVER_MINOR=",  "WXVER_RELEASE=", "BUILD=",
+        "MONOLITHIC=",       "SHARED=",       "UNICODE=",       "TOOLKIT=",
+        "TOOLKIT_VERSION=",  "WXUNIV=",       "CFG=",           "VENDOR=",
+        "OFFICIAL_BUILD=",   "DEBUG_FLAG=",   "DEBUG_INFO=",    "RUNTIME_LIBS=",
+        "USE_EXCEPTIONS=",   "USE_RTTI=",     "USE_THREADS=",   "USE_AUI=",
+        "USE_GUI=",          "USE_HTML=",     "USE_MEDIA=",     "USE_OPENGL=",
+        "USE_QA=",           "USE_PROPGRID=", "USE_RIBBON=",    "USE_RICHTEXT=",
+        "USE_STC=",          "USE_WEBVIEW=",  "USE_XRC=",       "COMPILER=",
+        "COMPILER_VERSION=", "CC=",           "CXX=",           "CFLAGS=",
+        "CPPFLAGS=",         "CXXFLAGS=",     "LDFLAGS="};
+    // predefined values
+    // I couldn't find a convenient place to read these values
+    // so I fill them with the following values
+    // feel free to change the code before execution or the file after
+    config[3] += "debug";   // BUILD
+    config[4] += "0";       // MONOLITHIC
+    config[5] += "0";       // SHARED
+    config[9] += "0";       // WXUNIV
+    config[11] += "custom"; // VENDOR
+    config[12] += "0";      // OFFICIAL_BUILD
+    config[13] += "0";      // DEBUG_FLAG
+    config[14] += "0";      // DEBUG_INFO
+    config[15] += "static"; // RUNTIME_LIBS
+    config[17] += "1";      // USE_RTTI  (is this equivalent to wxUSE_EXTENDED_RTTI?)
+    config[24] += "1";      // USE_QA
+    // the compiler on PATH, probed once
+    const Toolchain &tools = toolchain(build);
+    config[31] += tools.compiler; // COMPILER
+    config[32] += tools.version;  // COMPILER_VERSION
+    config[33] += tools.cc;       // CC
+    config[34] += tools.cxx;      // CXX
+
+    // version
+    std::string ver = folderVersion(build.wxwin);
+    if(ver != "") {
+        config[0].push_back(ver[0]);
+        config[1].push_back(ver[2]);
+        config[2].push_back(ver[4]);
+    }
+    // TOOLKIT
+    // reading from WXCFG
+    const std::string &wxcfg = build.wxcfg;
+    if(wxcfg != "") {
+        std::string inc = "include";
+        pos = wxcfg.find(inc);
+        if(pos != std::string::npos) {
+            pos2 = wxcfg.find("-", pos + inc.length());
+            if(pos2 != std::string::npos)
+                config[7] += toUpperCase(
+                    wxcfg.substr(pos + inc.length() + 1, pos2 - pos - inc.length() - 1));
+        }
+    }
+    // read setup.h for other values
+    const SetupModel &setup = setupModel(build);
+    if(!setup.loaded) {
+        std::cerr << "Error: Could not open file " << setuph << std::endl;
+        return false;
+    }
+    if(ver == "" && setup.version.length() >= 3) {
+        config[0].push_back(setup.version[0]);
+        config[1].push_back(setup.version[2]);
+        config[2].push_back('5'); // fallback value
+    }
+    config[6] += setupValue(setup.unicode);
+    config[16] += setupValue(setup.exceptions);
+    config[18] += setupValue(setup.threads);
+    config[19] += setupValue(setup.aui);
+    config[20] += setupValue(setup.gui);
+    config[21] += setupValue(setup.html);
+    config[22] += setupValue(setup.mediactrl);
+    config[23] += setupValue(setup.opengl);
+    config[25] += setupValue(setup.propgrid);
+    config[26] += setupValue(setup.ribbon);
+    config[27] += setupValue(setup.richtext);
+    config[28] += setupValue(setup.stc);
+    config[29] += setupValue(setup.webview);
+    config[30] += setupValue(setup.xrc);
+    lines.assign(config, config + 39);
+    return true;
+}
+
+// the keys that come from setup.h, they follow it unless they were edited
+bool isSetupHKey(const std::string &key) {
+    const char *keys[] = {"UNICODE",      "USE_EXCEPTIONS", "USE_THREADS",  "USE_AUI",
+                          "USE_GUI",      "USE_HTML",       "USE_MEDIA",    "USE_OPENGL",
+                          "USE_PROPGRID", "USE_RIBBON",     "USE_RICHTEXT", "USE_STC",
+                          "USE_WEBVIEW",  "USE_XRC"};
+    for(const char *name : keys) {
+        if(key == name) return true;
+    }
+    return false;
+}
+
+// key and value of a build.cfg line, false for lines without one
+bool splitCfgLine(std::string line, std::string &key, std::string &value) {
+    strstrip(line);
+    size_t pos = line.find("=");
+    if(pos == std::string::npos) return false;
+    key = line.substr(0, pos);
+    value = line.substr(pos + 1);
+    return true;
+}
+
+// saved is the record of the last generation: the stamp and hash of setup.h, the compiler it
+// was probed from, then the lines, the compiler is only compared when tools isn't empty
+bool buildCfgFresh(const std::string &filename, const std::string &record,
+                   const std::string &stamp, const std::string &tools,
+                   std::vector<std::string> &saved, bool &exists) {
+    std::string savedText, line;
+    saved.clear();
+    if(readFile(record, savedText)) {
+        std::istringstream lines(savedText);
+        while(std::getline(lines, line)) saved.push_back(line);
+    }
+    exists = fileExists(filename);
+    // nothing to update it from without setup.h
+    if(exists && stamp == "-") return true;
+    return exists && saved.size() >= 3 && saved[0] == stamp && (tools == "" || saved[2] == tools);
+}
+
+// create build.cfg, and bring it up to date when setup.h changes, or the compiler with
+// checkCompiler, which finds and probes it, the compiler is probed anyway when it's written
+// the cache remembers what was generated last time with the stamp and hash of setup.h,
+// values that differ from it were edited by hand and stay as they are
+// build.cfg is only written when a value changes, so build tools don't rebuild for nothing
+// returns whether it was written
+bool createBuildCfg(const Build &build, bool checkCompiler) {
+    TraceScope trace("createBuildCfg");
+    if(build.wxwin == "" || build.wxcfg == "") return false;
+
+    std::string filename = cfgDir(build) + "/build.cfg", setuph = cfgDir(build) + "/wx/setup.h",
+                record = cacheDir(build) + "/build.cfg.generated", stamp = fileStamp(setuph),
+                tools = checkCompiler ? toolchainIdentity(build) : "";
+    std::vector<std::string> saved;
+    bool exists;
+    if(buildCfgFresh(filename, record, stamp, tools, saved, exists)) return false;
+    // one of the concurrent runs updates it, the others find it fresh once they get the lock
+    createDir(cacheDir(build));
+    FileLock lock(cacheDir(build) + "/build.cfg.lock", build.timeout);
+    if(buildCfgFresh(filename, record, stamp, tools, saved, exists)) return false;
+
+    // setup.h was only touched
+    std::string text, hash;
+    if(readFile(setuph, text)) hash = toHex(fnv1a(text));
+    if(exists && saved.size() >= 3 && hash != "" && saved[1] == hash &&
+       (tools == "" || saved[2] == tools)) {
+        saved[0] = stamp;
+        std::string content;
+        for(const std::string &item : saved) content += item + "\n";
+        writeFileAtomic(record, content);
+        return false;
+    }
+
+    std::vector<std::string> generated;
+    if(!generateBuildCfg(build, generated)) return false;
+    std::map<std::string, std::string> values, previous;
+    std::string key, value;
+    for(const std::string &item : generated) {
+        if(splitCfgLine(item, key, value)) values[key] = value;
+    }
+    for(size_t i = 3; i < saved.size(); i++) {
+        if(splitCfgLine(saved[i], key, value)) previous[key] = value;
+    }
+
+    std::string current, content, line;
+    if(exists && !readFile(filename, current)) return false;
+    // keep the line endings of the file
+    const char *newline = current.find("\r\n") != std::string::npos ? "\r\n" : "\n";
+    std::set<std::string> seen;
+    std::istringstream lines(current);
+    while(std::getline(lines, line)) {
+        std::map<std::string, std::string>::iterator found = values.end(), before;
+        if(splitCfgLine(line, key, value) && seen.insert(key).second) found = values.find(key);
+        if(found == values.end() || found->second == value) {
+            content += line + "\n";
+            continue;
+        }
+        // without a record of the last generation, only setup.h keys are known to be ours
+        before = previous.find(key);
+        bool edited = before != previous.end() ? before->second != value : !isSetupHKey(key);
+        content += edited ? line + "\n" : key + "=" + found->second + newline;
+    }
+    for(const std::string &item : generated) {
+        if(splitCfgLine(item, key, value) && !seen.count(key)) content += item + newline;
+    }
+
+    if(content != current && !writeFileAtomic(filename, content)) {
+        std::cerr << "Error: Could not write " << filename << std::endl;
+        return false;
+    }
+    if(tools == "") tools = toolchainIdentity(build);
+    std::string recordText = stamp + "\n" + hash + "\n" + tools + "\n";
+    for(const std::string &item : generated) recordText += item + "\n";
+    createDir(cacheDir(build));
+    writeFileAtomic(record, recordText);
+    return content != current;
+}
+
+// what a rewrite rule does with a token
+enum RuleKind {
+    SWAP,          // replace the whole token
+    RENAME,        // replace the prefix and append the version
+    STRIP_SEGMENT, // remove the folder before the match, unless it's the wxWidgets folder
+    COLLAPSE       // remove the last folder of the match
+};
+
+struct RewriteRule {
+    RuleKind kind;
+    const char *after;       // only applies after this token, NULL for any
+    const char *match;       // prefix for SWAP and RENAME, anywhere in the token otherwise
+    const char *replacement; // for SWAP and RENAME
+};
+
+// wx-config includes the build folder, the headers are in the source folder
+// and dynamic flags are replaced (I have no idea if the new value does anything)
+const RewriteRule includeRules[] = {
+    {SWAP, NULL, "-DWXUSINGDLL", "-DWX_STATIC"},
+    {SWAP, "--define", "WXUSINGDLL", "WX_STATIC"},
+    {STRIP_SEGMENT, NULL, "/include", NULL},
+};
+
+// the first rule fixes the library folder, the rest fixes library names
+// checked in order, so longer prefixes have to come first
+const RewriteRule libRules[] = {
+    {COLLAPSE, NULL, "lib/wx", NULL},
+    {RENAME, NULL, "-lwxmsw32ud", "-lwx_mswu"},
+    {RENAME, NULL, "-lwxmsw32u", "-lwx_mswu"},
+    {RENAME, NULL, "-lwxmsw32d", "-lwx_msw"},
+    {RENAME, NULL, "-lwxmsw32", "-lwx_msw"},
+    {RENAME, NULL, "-lwxbase32ud", "-lwx_baseu"},
+    {RENAME, NULL, "-lwxbase32u", "-lwx_baseu"},
+    {RENAME, NULL, "-lwxbase32d", "-lwx_base"},
+    {RENAME, NULL, "-lwxbase32", "-lwx_base"},
+    {RENAME, NULL, "-lwxscintillad", "-lwxscintilla"},
+    {RENAME, NULL, "-lwxscintilla", "-lwxscintilla"},
+};
+
+bool startsWith(std::string_view str, std::string_view prefix) {
+    return str.substr(0, prefix.length()) == prefix;
+}
+
+// copy a token without the folders the path rule removes
+void rewritePath(std::string_view token, const RewriteRule &rule, std::string &out) {
+    std::string_view match = rule.match;
+    size_t copied = 0, pos = token.find(match);
+    while(pos != std::string_view::npos) {
+        size_t next = pos + match.length();
+        if(rule.kind == STRIP_SEGMENT) {
+            // if the string isn't "/include/", drop the folder in front of it
+            size_t bgn = pos > 0 ? token.rfind('/', pos - 1) : std::string_view::npos;
+            if(next < token.length() && token[next] == '/') bgn = std::string_view::npos;
+            if(bgn != std::string_view::npos && bgn >= copied &&
+               token.substr(bgn, pos - bgn).find("wxWidgets") == std::string_view::npos) {
+                out.append(token.substr(copied, bgn - copied));
+                copied = pos;
+            }
+        } else if(next == token.length() || (!isNameChar(token[next]) && token[next] != '/' &&
+                                             token[next] != '-' && token[next] != '.')) {
+            // "lib/wx" is the last folder, remove "/wx"
+            out.append(token.substr(copied, pos + 3 - copied));
+            copied = next;
+        }
+        pos = token.find(match, next);
+    }
+    out.append(token.substr(copied));
+}
+
+// version is what renamed libraries end in
+void rewriteToken(std::string_view token, std::string_view previous, const RewriteRule *rules,
+                  size_t count, std::string_view version, std::string &out) {
+    const RewriteRule *path = NULL;
+    for(size_t i = 0; i < count; i++) {
+        const RewriteRule &rule = rules[i];
+        if(rule.kind == STRIP_SEGMENT || rule.kind == COLLAPSE) {
+            path = &rule;
+            continue;
+        }
+        if((rule.after && previous != rule.after) || !startsWith(token, rule.match)) continue;
+        if(rule.kind == SWAP) {
+            out += rule.replacement;
+            return;
+        }
+        // only whole library names, "-lwxscintilla-3.2" is already fixed
+        std::string_view rest = token.substr(strlen(rule.match));
+        if(rest.length() > 0 && rest[0] != '_') continue;
+        out += rule.replacement;
+        out.append(rest);
+        out += "-";
+        out.append(version);
+        return;
+    }
+    if(path) {
+        rewritePath(token, *path, out);
+    } else {
+        out.append(token);
+    }
+}
+
+// split wx-config output into tokens once and rewrite them into out,
+// the whitespace between tokens is kept as it is
+// previous is the last token of the text before str, and becomes the last token of str
+void rewriteFlags(std::string_view str, const RewriteRule *rules, size_t count,
+                  std::string_view version, std::string &out, std::string &last) {
+    const char *space = " \t\r\n";
+    size_t capacity = out.capacity();
+    std::string_view previous = last;
+    size_t pos = 0;
+    while(pos < str.length()) {
+        size_t begin = str.find_first_not_of(space, pos);
+        if(begin == std::string_view::npos) begin = str.length();
+        out.append(str.substr(pos, begin - pos));
+        if(begin == str.length()) break;
+        size_t end = str.find_first_of(space, begin);
+        if(end == std::string_view::npos) end = str.length();
+        std::string_view token = str.substr(begin, end - begin);
+        rewriteToken(token, previous, rules, count, version, out);
+        previous = token;
+        pos = end;
+    }
+    last = std::string(previous);
+    // the output outgrew the room reserved for it
+    if(out.capacity() != capacity) traceCount(traceCounters.reallocations, 1);
+}
+
+// rewrites tokens while wx-config is still writing them
+struct StreamRewriter {
+    const RewriteRule *rules;
+    size_t count;
+    std::string version, out, pending, previous;
+
+    StreamRewriter(const RewriteRule *rules, size_t count, const std::string &version)
+        : rules(rules), count(count), version(version) {}
+
+    void feed(std::string_view chunk) {
+        pending.append(chunk);
+        // only whole tokens, the last one may continue in the next chunk
+        size_t end = pending.find_last_of(" \t\r\n");
+        if(end == std::string::npos) return;
+        rewriteFlags(std::string_view(pending).substr(0, end + 1), rules, count, version, out,
+                     previous);
+        pending.erase(0, end + 1);
+    }
+
+    void finish() {
+        rewriteFlags(pending, rules, count, version, out, previous);
+        pending.clear();
+    }
+};
+
+// renames make a token at most a few characters longer
+size_t rewrittenSize(std::string_view str) { return str.length() + str.length() / 2 + 16; }
+
+// fix the include directories
+std::string fixInclude(std::string_view str) {
+    TraceScope trace("fixInclude");
+    std::string out, previous;
+    out.reserve(rewrittenSize(str));
+    // the include rules don't rename anything
+    rewriteFlags(str, includeRules, sizeof(includeRules) / sizeof(includeRules[0]), "", out,
+                 previous);
+    return out;
+}
+
+// read setup.h for library options and add libraries accordingly
+// edit your setup.h to change the list of additions
+std::string addSetupHLibs(const Build &build) {
+    TraceScope trace("addSetupHLibs");
+    const SetupModel &setup = setupModel(build);
+    if(!setup.loaded) {
+        std::cerr << "Error: Could not open file " << cfgDir(build) + "/wx/setup.h" << std::endl;
+        return "";
+    }
+    std::string temp = "", version = wxVersion(build);
+    // start with wxWidgets libraries
+    if(setup.aui > 0) temp += "-lwx_mswu_aui-" + version + " ";
+    if(setup.mediactrl > 0) temp += "-lwx_mswu_media-" + version + " ";
+    if(setup.opengl > 0) temp += "-lwx_mswu_gl-" + version + " ";
+    if(setup.propgrid > 0) temp += "-lwx_mswu_propgrid-" + version + " ";
+    if(setup.ribbon > 0) temp += "-lwx_mswu_ribbon-" + version + " ";
+    if(setup.richtext > 0) temp += "-lwx_mswu_richtext-" + version + " ";
+    if(setup.stc > 0) {
+        temp += "-lwx_mswu_stc-" + version + " ";
+        temp += "-lwxscintilla-" + version + " ";
+    }
+    // add non-wx libraries
+    // this isn't the correct flag, but it is referred for value
+    if(setup.graphicsContext > 0) temp += "-lgdiplus ";
+    if(setup.libjpeg > 0) temp += "-ljpeg ";
+    if(setup.libpng > 0) temp += "-lpng ";
+    if(setup.libtiff > 0) temp += "-ltiff ";
+    if(setup.ole > 0) {
+        temp += "-lole32 ";
+        temp += "-loleaut32 ";
+        // it is recommended to only add this if necessary
+        // it causes compilation to fail because it is not found
+        // temp += "-lole2w32 ";
+    }
+    if(setup.sockets > 0) temp += "-lwsock32 ";
+    // wx-config uses XRC flag for this, but XML library depends on it too
+    if(setup.xrc > 0 || setup.xml > 0) temp += "-lexpat ";
+    if(setup.zlib > 0) temp += "-lz ";
+    return temp;
+}
+
+std::string addFlaglessLibs(bool custom) {
+    // these are simply always (supposed to be) added by wx-config
+    // if you wish to fine-tune these additions manually, use "--wxflagsCUSTOM
+    if(!custom) {
+        return "-lkernel32 -luser32 -lgdi32 -lcomdlg32 -lwinspool -lwinmm "
+               "-lshell32 -lcomctl32 -lversion -lshlwapi -luxtheme "
+               "-luuid -lrpcrt4 -ladvapi32 -loleacc ";
+    }
+    return "";
+}
+
+// add setup.h libraries
+std::string addLibs(const Build &build, bool custom) {
+    // read setup.h in $(BUILDDIR)\lib\wx\include\msw-unicode-static-WXVER\wx
+    return addSetupHLibs(build) + addFlaglessLibs(custom);
+}
+
+// fix library names
+std::string fixLibNames(std::string_view str, const std::string &version) {
+    std::string out, previous;
+    out.reserve(rewrittenSize(str));
+    // without the folder rule
+    rewriteFlags(str, libRules + 1, sizeof(libRules) / sizeof(libRules[0]) - 1, version, out,
+                 previous);
+    return out;
+}
+
+// add the libraries wx-config couldn't to rewritten library flags
+void finishLibs(std::string &out, const std::string &libs) {
+    strstrip(out);
+    out.reserve(out.length() + libs.length() + 2);
+    out += " ";
+    out += libs;
+    out += "\n";
+}
+
+// fix the library flags, libs are the libraries from addLibs()
+std::string fixLibs(std::string_view str, const std::string &libs, const std::string &version) {
+    TraceScope trace("fixLibs");
+    std::string out, previous;
+    out.reserve(rewrittenSize(str));
+    // fix directories and library names
+    rewriteFlags(str, libRules, sizeof(libRules) / sizeof(libRules[0]), version, out, previous);
+    finishLibs(out, libs);
+    return out;
+}
+
+std::string fixLibs(const Build &build, std::string_view str, bool custom) {
+    return fixLibs(str, addLibs(build, custom), wxVersion(build));
+}
+
+bool isDynamic(int argc, char *argv[]) {
+    std::string str_dynamic = "--wxflagsDYNAMIC";
+    for(int i = 0; i < argc; i++) {
+        if(argv[i] == str_dynamic) return true;
+    }
+    return false;
+}
+
+bool isCustom(int argc, char *argv[]) {
+    std::string str_custom = "--wxflagsCUSTOM";
+    for(int i = 0; i < argc; i++) {
+        if(argv[i] == str_custom) return true;
+    }
+    return false;
+}
+
+bool isLibs(int argc, char *argv[]) {
+    std::string str_dynamic = "--libs";
+    for(int i = 0; i < argc; i++) {
+        if(argv[i] == str_dynamic) return true;
+    }
+    return false;
+}
+
+bool isCFlags(int argc, char *argv[]) {
+    std::string str_dynamic = "--cflags";
+    for(int i = 0; i < argc; i++) {
+        if(argv[i] == str_dynamic) return true;
+    }
+    return false;
+}
+
+bool isRcFlags(int argc, char *argv[]) {
+    std::string str_dynamic = "--rcflags";
+    for(int i = 0; i < argc; i++) {
+        if(argv[i] == str_dynamic) return true;
+    }
+    return false;
+}
+
+// check if a wx-flags option is given
+bool hasFlag(int argc, char *argv[], const std::string &flag) {
+    for(int i = 0; i < argc; i++) {
+        if(argv[i] == flag) return true;
+    }
+    return false;
+}
+
+// value of a wx-flags option like --wxflagsEXPORT=cmake, "" if not given
+std::string flagValue(int argc, char *argv[], const std::string &flag) {
+    for(int i = 0; i < argc; i++) {
+        if(std::string(argv[i]).rfind(flag, 0) == 0) return argv[i] + flag.length();
+    }
+    return "";
+}
+
+// the wx-config command line, --prefix=, --wxcfg= and --wxflagsTIMEOUT= go into build
+std::string createCommand(int argc, char *argv[], Build &build) {
+    std::string temp = "wx-config", str_wxflags = "--wxflags", str_prefix = "--prefix=",
+                str_wxcfg = "--wxcfg=", str_timeout = "--wxflagsTIMEOUT=";
+    for(int i = 1; i < argc; ++i) {
+        // wx-flags options are never passed to wx-config
+        if(std::string(argv[i]).rfind(str_wxflags, 0) != 0) {
+            temp += " ";
+            temp += argv[i];
+        }
+        // set environment variables if provided as flags
+        // this one takes priority
+        if(std::string(argv[i]).find(str_prefix) != std::string::npos) {
+            build.wxwin = std::string(argv[i]).substr(str_prefix.length(), std::string::npos);
+        }
+        if(std::string(argv[i]).find(str_wxcfg) != std::string::npos) {
+            build.wxcfg = std::string(argv[i]).substr(str_wxcfg.length(), std::string::npos);
+        }
+        if(std::string(argv[i]).rfind(str_timeout, 0) == 0) {
+            build.timeout = atoi(argv[i] + str_timeout.length()) * 1000;
+        }
+    }
+    return temp;
+}
+
+#ifndef _WIN32
+// split a command line like CreateProcess would, double quotes keep spaces in an argument
+std::vector<std::string> splitCommand(const std::string &command) {
+    std::vector<std::string> args;
+    std::string arg;
+    bool quoted = false, started = false;
+    for(char c : command) {
+        if(c == '"') {
+            quoted = !quoted;
+            started = true;
+        } else if(isspace((unsigned char)c) && !quoted) {
+            if(started) args.push_back(arg);
+            arg.clear();
+            started = false;
+        } else {
+            arg += c;
+            started = true;
+        }
+    }
+    if(started) args.push_back(arg);
+    return args;
+}
+#endif
+
+// run a command, pass its output to onOutput as it arrives and stop it after timeout ms
+// onStarted runs once the child does, for work that can overlap with it
+// the child gets this process's environment with the variables in environment replaced
+ProcessResult runProcess(const std::string &command,
+                         const std::function<void(std::string_view)> &onOutput, int timeout,
+                         const std::function<void()> &onStarted,
+                         const std::vector<std::string> &environment) {
+    ProcessResult result;
+    char buffer[4096];
+#ifdef _WIN32
+    // Create pipes for the child process's output and errors
+    HANDLE outRead, outWrite, errRead, errWrite;
+    SECURITY_ATTRIBUTES saAttr = {sizeof(SECURITY_ATTRIBUTES), NULL, FALSE};
+
+    if(!CreatePipe(&outRead, &outWrite, &saAttr, 0)) {
+        std::cerr << "Error creating pipe" << std::endl;
+        return result;
+    }
+    if(!CreatePipe(&errRead, &errWrite, &saAttr, 0)) {
+        std::cerr << "Error creating pipe" << std::endl;
+        CloseHandle(outRead);
+        CloseHandle(outWrite);
+        return result;
+    }
+
+    // Set up the STARTUPINFO structure.
+    STARTUPINFO si = {sizeof(STARTUPINFO)};
+    si.dwFlags = STARTF_USESTDHANDLES;
+    si.hStdOutput = outWrite;
+    si.hStdError = errWrite;
+
+    // Set up the PROCESS_INFORMATION structure.
+    PROCESS_INFORMATION pi;
+
+    // Create the child process, CreateProcess may modify the command line.
+    std::string commandLine = command, program, block;
+    if(!environment.empty()) {
+        // CreateProcess looks for the program on this process's PATH
+        if(findVariable(environment, "PATH")) {
+            size_t end = command[0] == '"' ? command.find('"', 1) : command.find(' ');
+            program = command[0] == '"' ? command.substr(1, end - 1) : command.substr(0, end);
+            program = findProgram(program, environment);
+            if(program == "") program = "-";
+        }
+        char *strings = GetEnvironmentStrings();
+        for(const char *variable = strings; *variable; variable += strlen(variable) + 1) {
+            // the hidden per drive variables start with =
+            std::string name(variable, strchr(variable + 1, '=') - variable);
+            if(!findVariable(environment, name)) block.append(variable, strlen(variable) + 1);
+        }
+        FreeEnvironmentStrings(strings);
+        for(const std::string &variable : environment) {
+            if(variable.find('=') != std::string::npos)
+                block.append(variable.c_str(), variable.length() + 1);
+        }
+        block.push_back('\0');
+    }
+    bool created;
+    {
+        // only the write ends are inherited, and only by this child, a child started
+        // by another thread at the same time would keep the pipes open
+        static std::mutex inheritLock;
+        std::lock_guard<std::mutex> lock(inheritLock);
+        SetHandleInformation(outWrite, HANDLE_FLAG_INHERIT, HANDLE_FLAG_INHERIT);
+        SetHandleInformation(errWrite, HANDLE_FLAG_INHERIT, HANDLE_FLAG_INHERIT);
+        created = CreateProcess(program == "" ? NULL : program.c_str(), &commandLine[0], NULL,
+                                NULL, TRUE, 0, block == "" ? NULL : &block[0], NULL, &si, &pi);
+
+        // Close the write ends of the pipes so reading ends when the child does.
+        CloseHandle(outWrite);
+        CloseHandle(errWrite);
+    }
+    if(!created) {
+        std::cerr << "Error creating process" << std::endl;
+        CloseHandle(outRead);
+        CloseHandle(errRead);
+        return result;
+    }
+    traceCount(traceCounters.processes, 1);
+    if(onStarted) onStarted();
+
+    // errors are read on their own thread so neither pipe can fill up and block the child
+    std::thread errors([&] {
+        char errBuffer[4096];
+        DWORD bytesRead;
+        while(ReadFile(errRead, errBuffer, sizeof(errBuffer), &bytesRead, NULL) && bytesRead > 0) {
+            traceCount(traceCounters.bytesRead, bytesRead);
+            result.errors.append(errBuffer, bytesRead);
+        }
+    });
+    // ending the child also ends the reads
+    std::thread watchdog([&] {
+        if(WaitForSingleObject(pi.hProcess, timeout) == WAIT_TIMEOUT) {
+            result.timedOut = true;
+            TerminateProcess(pi.hProcess, 1);
+        }
+    });
+
+    DWORD bytesRead;
+    while(ReadFile(outRead, buffer, sizeof(buffer), &bytesRead, NULL) && bytesRead > 0) {
+        traceCount(traceCounters.bytesRead, bytesRead);
+        onOutput(std::string_view(buffer, bytesRead));
+    }
+    errors.join();
+    watchdog.join();
+
+    DWORD exitCode;
+    WaitForSingleObject(pi.hProcess, INFINITE);
+    if(GetExitCodeProcess(pi.hProcess, &exitCode)) result.exitCode = exitCode;
+
+    // Close handles
+    CloseHandle(outRead);
+    CloseHandle(errRead);
+    CloseHandle(pi.hProcess);
+    CloseHandle(pi.hThread);
+#else
+    int out[2], err[2];
+    if(pipe2(out, O_CLOEXEC) < 0) {
+        std::cerr << "Error creating pipe" << std::endl;
+        return result;
+    }
+    if(pipe2(err, O_CLOEXEC) < 0) {
+        std::cerr << "Error creating pipe" << std::endl;
+        close(out[0]);
+        close(out[1]);
+        return result;
+    }
+    std::vector<std::string> args = splitCommand(command);
+    std::vector<char *> argv;
+    for(std::string &arg : args) argv.push_back(&arg[0]);
+    argv.push_back(NULL);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, err[1], STDERR_FILENO);
+    // posix_spawnp() looks for the program on this process's PATH
+    std::string program = args.empty() ? "" : args[0];
+    if(!args.empty() && findVariable(environment, "PATH") && program.find('/') == std::string::npos)
+        program = findProgram(program, environment);
+    std::vector<char *> envp;
+    for(char **variable = environ; *variable; variable++) {
+        std::string name(*variable, strcspn(*variable, "="));
+        if(!findVariable(environment, name)) envp.push_back(*variable);
+    }
+    for(const std::string &variable : environment) {
+        if(variable.find('=') != std::string::npos)
+            envp.push_back(const_cast<char *>(variable.c_str()));
+    }
+    envp.push_back(NULL);
+    pid_t pid;
+    int error = program == "" ? ENOENT
+                              : posix_spawnp(&pid, program.c_str(), &actions, NULL, argv.data(),
+                                             envp.data());
+    posix_spawn_file_actions_destroy(&actions);
+    // close the write ends so reading ends when the child does
+    close(out[1]);
+    close(err[1]);
+    if(error != 0) {
+        std::cerr << "Error creating process" << std::endl;
+        close(out[0]);
+        close(err[0]);
+        return result;
+    }
+    traceCount(traceCounters.processes, 1);
+    if(onStarted) onStarted();
+
+    // read both pipes as data arrives so neither can fill up and block the child
+    pollfd fds[2] = {{out[0], POLLIN, 0}, {err[0], POLLIN, 0}};
+    int open = 2;
+    std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+    while(open > 0) {
+        int left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       deadline - std::chrono::steady_clock::now())
+                       .count();
+        if(left <= 0) {
+            result.timedOut = true;
+            kill(pid, SIGKILL);
+            break;
+        }
+        if(poll(fds, 2, left) < 0) {
+            if(errno == EINTR) continue;
+            break;
+        }
+        for(pollfd &fd : fds) {
+            if(fd.fd < 0 || !(fd.revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            ssize_t bytesRead = read(fd.fd, buffer, sizeof(buffer));
+            if(bytesRead > 0) {
+                traceCount(traceCounters.bytesRead, bytesRead);
+                if(fd.fd == out[0]) {
+                    onOutput(std::string_view(buffer, bytesRead));
+                } else {
+                    result.errors.append(buffer, bytesRead);
+                }
+            } else if(bytesRead == 0 || errno != EINTR) {
+                close(fd.fd);
+                fd.fd = -1;
+                open--;
+            }
+        }
+    }
+    for(pollfd &fd : fds) {
+        if(fd.fd >= 0) close(fd.fd);
+    }
+
+    int status;
+    while(waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    if(WIFEXITED(status)) {
+        result.exitCode = WEXITSTATUS(status);
+    } else if(WIFSIGNALED(status)) {
+        result.exitCode = 128 + WTERMSIG(status);
+    }
+#endif
+    return result;
+}
+
+// the exit status of a wx-config run
+int wxconfigStatus(const Build &build, const ProcessResult &result) {
+    // wx-config's own messages stay on stderr instead of ending up in the flags
+    std::cerr << result.errors;
+    if(result.timedOut) {
+        std::cerr << "Error: wx-config didn't finish in " << build.timeout / 1000 << " seconds"
+                  << std::endl;
+        return 1;
+    }
+    if(result.exitCode < 0) return 1;
+    if(result.exitCode > 0)
+        std::cerr << "Error: wx-config exited with code " << result.exitCode << std::endl;
+    return result.exitCode;
+}
+
+// run wx-config, pass its output on as it arrives and return its exit status
+int wxconfig(const Build &build, const std::string &command,
+             const std::function<void(std::string_view)> &onOutput) {
+    TraceScope trace("wxconfig");
+    return wxconfigStatus(
+        build, runProcess(command, onOutput, build.timeout, nullptr, build.environment));
+}
+
+// run wx-config and collect its output
+std::string wxconfig(const Build &build, const std::string &command, int &status) {
+    std::string output;
+    status = wxconfig(build, command, [&](std::string_view chunk) { output.append(chunk); });
+    return output;
+}
+
+// read build.cfg into key/value pairs
+std::map<std::string, std::string> readBuildCfg(const Build &build) {
+    std::map<std::string, std::string> cfg;
+    std::ifstream file(cfgDir(build) + "/build.cfg");
+    std::string line;
+    while(std::getline(file, line)) {
+        strstrip(line);
+        size_t pos = line.find("=");
+        if(pos != std::string::npos) cfg[line.substr(0, pos)] = line.substr(pos + 1);
+    }
+    return cfg;
+}
+
+// wx-config reports paths with forward slashes
+std::string slashes(std::string str) {
+    for(char &c : str)
+        if(c == '\\') c = '/';
+    return str;
+}
+
+// the compiler builds use, $CXX or the first one on PATH, "" if there's none
+std::string findCompiler(const Build &build) {
+    const char *cxx = getBuildEnv(build.environment, "CXX");
+    if(cxx && *cxx) {
+        std::string name = cxx;
+#ifndef _WIN32
+        if(name.find('/') != std::string::npos) return access(cxx, X_OK) == 0 ? name : "";
+#endif
+        return findProgram(name, build.environment);
+    }
+    for(const char *name : {"clang++", "g++", "c++"}) {
+        std::string path = findProgram(name, build.environment);
+        if(path != "") return path;
+    }
+    return "";
+}
+
+bool probeCommand(const Build &build, const std::string &command) {
+    ProcessResult result =
+        runProcess(command, [](std::string_view) {}, build.timeout, nullptr, build.environment);
+    return !result.timedOut && result.exitCode == 0;
+}
+
+// run the compiler and its linker on an empty program with each option
+Toolchain probeToolchain(const Build &build, const std::string &compiler) {
+    Toolchain tools;
+    std::string quoted = "\"" + compiler + "\"", output;
+    ProcessResult result = runProcess(
+        quoted + " --version", [&](std::string_view chunk) { output.append(chunk); },
+        build.timeout, nullptr, build.environment);
+    if(result.timedOut || result.exitCode != 0) return tools;
+    std::string first = output.substr(0, output.find('\n'));
+    tools.compiler = first.find("clang") != std::string::npos ? "clang" : "gcc";
+    // the first number with a dot in it, without a distribution's suffix
+    std::istringstream words(first);
+    std::string word;
+    while(words >> word) {
+        if(isdigit((unsigned char)word[0]) && word.find('.') != std::string::npos) {
+            tools.version = word.substr(0, word.find_first_not_of("0123456789."));
+            break;
+        }
+    }
+    // clang++ goes with clang, g++ with gcc and c++ with cc
+    std::string name = slashes(compiler);
+    name = name.substr(name.rfind('/') + 1);
+    if(toLowerCase(name).size() > 4 && toLowerCase(name.substr(name.size() - 4)) == ".exe")
+        name.erase(name.size() - 4);
+    tools.cxx = tools.cc = name;
+    size_t pos = name.find("++");
+    if(pos != std::string::npos) {
+        std::string before = name.substr(0, pos);
+        if(before.size() >= 5 && before.substr(before.size() - 5) == "clang") {
+            tools.cc.erase(pos, 2);
+        } else {
+            tools.cc.replace(pos, 2, before != "" && before.back() == 'g' ? "cc" : "c");
+        }
+    }
+
+    createDir(cacheDir(build));
+    std::string base = cacheDir(build) + "/probe-" + std::to_string(processId()),
+                source = base + ".cpp";
+    writeFileAtomic(source, "int main() { return 0; }\n");
+    std::string link = quoted + " \"" + source + "\" -o \"" + base + ".out\"";
+    auto probe = [&](const std::string &command) { return probeCommand(build, command); };
+    if(probe(link)) {
+        tools.lld = probe(link + " -fuse-ld=lld");
+        tools.mold = probe(link + " -fuse-ld=mold");
+        tools.gcSections = probe(link + " -Wl,--gc-sections");
+        std::string linker = tools.mold ? " -fuse-ld=mold" : tools.lld ? " -fuse-ld=lld" : "";
+        tools.thinLto = linker != "" && probe(link + linker +
+                                              " -flto=thin -Wl,--thinlto-cache-dir=\"" +
+                                              cacheDir(build) + "/thinlto\"");
+        tools.splitDwarf =
+            probe(quoted + " -gsplit-dwarf -c \"" + source + "\" -o \"" + base + ".o\"");
+    }
+    for(const char *extension : {".cpp", ".out", ".out.exe", ".o", ".dwo"})
+        remove((base + extension).c_str());
+    return tools;
+}
+
+// the probe is saved with the path and stamp of the compiler it ran
+bool readToolchain(const std::string &filename, const std::string &key, Toolchain &tools) {
+    std::ifstream file(filename);
+    std::string line, header;
+    while(std::getline(file, line) && line != "") header += line + "\n";
+    if(header != key) return false;
+    while(std::getline(file, line)) {
+        size_t pos = line.find("=");
+        if(pos == std::string::npos) continue;
+        std::string name = line.substr(0, pos), value = line.substr(pos + 1);
+        if(name == "compiler") tools.compiler = value;
+        if(name == "version") tools.version = value;
+        if(name == "cc") tools.cc = value;
+        if(name == "cxx") tools.cxx = value;
+        if(name == "lld") tools.lld = value == "1";
+        if(name == "mold") tools.mold = value == "1";
+        if(name == "gc-sections") tools.gcSections = value == "1";
+        if(name == "thinlto") tools.thinLto = value == "1";
+        if(name == "split-dwarf") tools.splitDwarf = value == "1";
+    }
+    return true;
+}
+
+void writeToolchain(const std::string &filename, const std::string &key, const Toolchain &tools) {
+    std::string content = key + "\ncompiler=" + tools.compiler + "\nversion=" + tools.version +
+                          "\ncc=" + tools.cc + "\ncxx=" + tools.cxx +
+                          "\nlld=" + (tools.lld ? "1" : "0") + "\nmold=" + (tools.mold ? "1" : "0") +
+                          "\ngc-sections=" + (tools.gcSections ? "1" : "0") +
+                          "\nthinlto=" + (tools.thinLto ? "1" : "0") +
+                          "\nsplit-dwarf=" + (tools.splitDwarf ? "1" : "0") + "\n";
+    writeFileAtomic(filename, content);
+}
+
+// probed toolchains by compiler and its stamp, the probe runs once per compiler binary
+std::map<std::string, Toolchain> toolchains;
+std::mutex toolchainsLock;
+
+const Toolchain &toolchain(const Build &build) {
+    std::string compiler = findCompiler(build),
+                key = compiler == "" ? "" : compiler + "\n" + fileStamp(compiler) + "\n";
+    {
+        std::lock_guard<std::mutex> lock(toolchainsLock);
+        std::map<std::string, Toolchain>::iterator found = toolchains.find(key);
+        if(found != toolchains.end()) return found->second;
+    }
+    Toolchain tools;
+    if(compiler != "") {
+        std::string filename = cacheDir(build) + "/toolchain-" + toHex(fnv1a(compiler));
+        if(!readToolchain(filename, key, tools)) {
+            // concurrent runs wait for one probe
+            createDir(cacheDir(build));
+            FileLock lock(filename + ".lock", build.timeout);
+            if(!readToolchain(filename, key, tools)) {
+                tools = probeToolchain(build, compiler);
+                writeToolchain(filename, key, tools);
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(toolchainsLock);
+    return toolchains.emplace(key, tools).first->second;
+}
+
+// the compiler's path, stamp and version on one line, for what depends on the toolchain
+std::string toolchainIdentity(const Build &build) {
+    std::string compiler = findCompiler(build);
+    if(compiler == "") return "-";
+    return compiler + " " + fileStamp(compiler) + " " + toolchain(build).version;
+}
+
+// the wxWidgets source folder, which is what fixInclude() turns "WXWIN/include" into
+std::string sourceDir(const Build &build) {
+    std::string dir = slashes(build.wxwin);
+    size_t pos = dir.rfind("/");
+    if(pos != std::string::npos && dir.substr(pos).find("wxWidgets") == std::string::npos)
+        dir.erase(pos);
+    return dir;
+}
+
+// the wx archives in WXWIN/lib whose name contains part
+std::vector<std::string> libFiles(const Build &build, const std::string &part) {
+    std::vector<std::string> names, files;
+#ifdef _WIN32
+    WIN32_FIND_DATA data;
+    HANDLE find = FindFirstFile((build.wxwin + "/lib/*" + part + "*").c_str(), &data);
+    if(find != INVALID_HANDLE_VALUE) {
+        do {
+            names.push_back(data.cFileName);
+        } while(FindNextFile(find, &data));
+        FindClose(find);
+    }
+#else
+    if(DIR *dir = opendir((build.wxwin + "/lib").c_str())) {
+        while(dirent *entry = readdir(dir)) {
+            if(strstr(entry->d_name, part.c_str())) names.push_back(entry->d_name);
+        }
+        closedir(dir);
+    }
+#endif
+    for(const std::string &name : names) {
+        size_t ext = name.rfind(".");
+        if(ext == std::string::npos) continue;
+        // libwx_mswu_core-3.2.a or wx_mswu_core-3.2.lib
+        if((name.substr(ext) == ".a" && name.rfind("lib", 0) == 0) || name.substr(ext) == ".lib")
+            files.push_back(name);
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// the names and stamps of archives in WXWIN/lib, so adding, removing or rebuilding one shows
+std::string archivesStamp(const Build &build, const std::vector<std::string> &files) {
+    std::string stamp = "";
+    for(const std::string &file : files)
+        stamp += file + "\n" + fileStamp(build.wxwin + "/lib/" + file) + "\n";
+    return stamp;
+}
+
+// what -l needs for an archive
+std::string libName(std::string_view file) {
+    if(startsWith(file, "lib") && file.substr(file.length() - 2) == ".a")
+        return std::string(file.substr(3, file.length() - 5));
+    return std::string(file.substr(0, file.rfind(".")));
+}
+
+// names of the wx archives in the library folder, as they would be passed to -l
+std::set<std::string> scanWxLibs(const Build &build) {
+    std::set<std::string> libs;
+    for(const std::string &file : libFiles(build, "wx_")) libs.insert(libName(file));
+    return libs;
+}
+
+// whether WXCFG names a shared build, like msw-unicode-3.2 or gcc_dll/mswu
+bool isSharedCfg(const std::string &wxcfg) {
+    std::string name = toLowerCase(slashes(wxcfg));
+    if(name.find("_dll") != std::string::npos) return true;
+    return name.rfind("wx/include/", 0) == 0 && name.find("-static-") == std::string::npos;
+}
+
+// --cflags and --rcflags without wx-config, from build.cfg
+// --cflags in the order wx-config prints them, the folders first
+std::string nativeCFlags(const Build &build, bool rc) {
+    std::map<std::string, std::string> cfg = readBuildCfg(build);
+    std::string define = rc ? "--define " : "-D", include = rc ? "--include-dir " : "-I",
+                folders = include + slashes(build.wxwin) + "/lib/" + slashes(build.wxcfg) + " " +
+                          include + sourceDir(build) + "/include",
+                temp = rc ? "" : folders + " -D_FILE_OFFSET_BITS=64 ";
+    // what fixInclude() makes of WXUSINGDLL, which wx-config prints for shared builds
+    bool shared = cfg["SHARED"] == "1" || isSharedCfg(build.wxcfg);
+    if(!rc && shared) temp += define + "WX_STATIC ";
+    temp += define + "__WX" + cfg["TOOLKIT"] + "__ ";
+    if(cfg["DEBUG_FLAG"] == "1") temp += define + "__WXDEBUG__ ";
+    if(cfg["WXUNIV"] == "1") temp += define + "__WXUNIVERSAL__ ";
+    if(!rc) {
+        if(cfg["USE_THREADS"] == "1") temp += "-mthreads ";
+        temp.back() = '\n';
+        return temp;
+    }
+    if(cfg["UNICODE"] == "1") temp += define + "_UNICODE ";
+    if(shared) temp += define + "WX_STATIC ";
+    return temp + folders + "\n";
+}
+
+// --libs without wx-config, from build.cfg, setup.h and the library folder
+std::string nativeLibs(const Build &build, bool custom) {
+    std::map<std::string, std::string> cfg = readBuildCfg(build);
+    std::string u = cfg["UNICODE"] == "1" ? "u" : "",
+                gui = "wx_" + toLowerCase(cfg["TOOLKIT"]) + u + "_", base = "wx_base" + u;
+    // the "std" set of wx-config in its order, names as fixLibNames() leaves them
+    std::vector<std::string> names;
+    if(cfg["USE_GUI"] != "0") {
+        if(cfg["USE_XRC"] == "1") names.push_back(gui + "xrc");
+        if(cfg["USE_HTML"] == "1") names.push_back(gui + "html");
+        if(cfg["USE_QA"] == "1") names.push_back(gui + "qa");
+        names.push_back(gui + "core");
+    }
+    names.push_back(base + "_xml");
+    names.push_back(base + "_net");
+    names.push_back(base);
+    // only keep archives that were built, unless the folder can't be read
+    std::set<std::string> built = scanWxLibs(build);
+    std::string temp = cfg["USE_THREADS"] == "1" ? "-mthreads " : "", version = wxVersion(build);
+    temp += "-L" + slashes(build.wxwin) + "/lib ";
+    for(std::string name : names) {
+        name += "-" + version;
+        if(built.empty() || built.count(name)) temp += "-l" + name + " ";
+    }
+    return temp + addLibs(build, custom) + "\n";
+}
+
+// native mode only knows the flags wx-flags rewrites, anything else goes to wx-config
+bool isNativeQuery(int argc, char *argv[]) {
+    if(!hasFlag(argc, argv, "--wxflagsNATIVE") || isDynamic(argc, argv)) return false;
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg != "--cflags" && arg != "--libs" && arg != "--rcflags" &&
+           arg.rfind("--prefix=", 0) != 0 && arg.rfind("--wxcfg=", 0) != 0 &&
+           arg.rfind("--wxflags", 0) != 0)
+            return false;
+    }
+    return true;
+}
+
+// the flag options wx-flags rewrites
+const char *categoryName(Category category) {
+    if(category == LIBS) return "libs";
+    return category == CFLAGS ? "cflags" : "rcflags";
+}
+
+// requested categories in the order they were given
+std::vector<Category> getCategories(int argc, char *argv[]) {
+    std::vector<Category> categories;
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        Category category;
+        if(arg == "--cflags") {
+            category = CFLAGS;
+        } else if(arg == "--rcflags") {
+            category = RCFLAGS;
+        } else if(arg == "--libs") {
+            category = LIBS;
+        } else {
+            continue;
+        }
+        if(std::find(categories.begin(), categories.end(), category) == categories.end())
+            categories.push_back(category);
+    }
+    return categories;
+}
+
+std::string nativeFlags(const Build &build, Category category, bool custom) {
+    if(category == LIBS) return nativeLibs(build, custom);
+    return nativeCFlags(build, category == RCFLAGS);
+}
+
+// split flags into tokens, keeping windres options together with their values
+std::vector<std::string> flagTokens(const std::string &str) {
+    std::vector<std::string> tokens;
+    std::istringstream stream(str);
+    std::string token, value;
+    while(stream >> token) {
+        if((token == "--define" || token == "--include-dir") && stream >> value)
+            token += " " + value;
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+// which category a token of a combined wx-config answer belongs to
+Category tokenCategory(std::string_view token) {
+    if(startsWith(token, "--define ") || startsWith(token, "--include-dir ") ||
+       token == "--use-temp-file")
+        return RCFLAGS;
+    if(startsWith(token, "-l") || startsWith(token, "-L") || startsWith(token, "-Wl,") ||
+       startsWith(token, "-static") || token == "-mwindows" || token == "-mconsole")
+        return LIBS;
+    return CFLAGS;
+}
+
+// wx-config answers several options on one line, give each category its tokens
+std::map<Category, std::string> splitCategories(const std::string &output,
+                                                const std::vector<Category> &categories) {
+    std::map<Category, std::string> sections;
+    std::set<std::pair<Category, std::string>> shared;
+    std::vector<std::string> tokens = flagTokens(output);
+    for(size_t i = 0; i < tokens.size(); i++) {
+        std::string_view token = tokens[i];
+        std::vector<Category> owners;
+        // wx-config adds these for both compiling and linking, once for each option
+        if(token == "-mthreads" || token == "-pthread") {
+            owners = {CFLAGS, LIBS};
+        } else {
+            owners = {tokenCategory(token)};
+        }
+        bool placed = false;
+        for(Category owner : owners) {
+            if(std::find(categories.begin(), categories.end(), owner) == categories.end()) continue;
+            placed = true;
+            if(owners.size() > 1 && !shared.insert({owner, tokens[i]}).second) continue;
+            sections[owner] += tokens[i] + " ";
+        }
+        // nothing else asked for it, keep it in the first category
+        if(!placed) sections[categories[0]] += tokens[i] + " ";
+    }
+    return sections;
+}
+
+// --wxflagsORDER sorts the wx libraries of --libs so each comes before the ones it needs,
+// which is read from the archives in WXWIN/lib once and kept in an index file
+
+uint64_t readLE(const char *data, int bytes) {
+    uint64_t value = 0;
+    for(int i = bytes - 1; i >= 0; i--) value = value << 8 | static_cast<unsigned char>(data[i]);
+    return value;
+}
+
+uint64_t readBE(const char *data, int bytes) {
+    uint64_t value = 0;
+    for(int i = 0; i < bytes; i++) value = value << 8 | static_cast<unsigned char>(data[i]);
+    return value;
+}
+
+void putLE32(std::string &out, uint32_t value) {
+    for(int i = 0; i < 4; i++) out.push_back(static_cast<char>(value >> (8 * i)));
+}
+
+// a NUL terminated string inside a table, empty if it is out of range
+std::string_view cString(std::string_view table, uint64_t offset) {
+    if(offset >= table.size()) return "";
+    std::string_view str = table.substr(offset);
+    return str.substr(0, str.find('\0'));
+}
+
+// calls onMember with the name and data of each member of an ar archive
+bool forEachMember(std::string_view archive,
+                   const std::function<void(std::string_view, std::string_view)> &onMember) {
+    if(!startsWith(archive, "!<arch>\n")) return false;
+    size_t pos = 8;
+    while(pos + 60 <= archive.size()) {
+        std::string_view name = archive.substr(pos, 16);
+        size_t size = strtoull(std::string(archive.substr(pos + 48, 10)).c_str(), NULL, 10);
+        pos += 60;
+        if(size > archive.size() - pos) return false;
+        std::string_view data = archive.substr(pos, size);
+        name = name.substr(0, name.find_last_not_of(' ') + 1);
+        if(startsWith(name, "#1/")) {
+            // BSD puts long names in front of the data
+            size_t length = strtoul(std::string(name.substr(3)).c_str(), NULL, 10);
+            if(length > data.size()) return false;
+            name = cString(data.substr(0, length), 0);
+            data.remove_prefix(length);
+        }
+        onMember(name, data);
+        pos += size + (size & 1);
+    }
+    return true;
+}
+
+bool isSymbolTable(std::string_view name) {
+    return name == "/" || name == "/SYM64/" || startsWith(name, "__.SYMDEF");
+}
+
+// the symbols an archive's symbol table says it defines
+void tableSymbols(std::string_view name, std::string_view table, std::set<std::string> &symbols) {
+    const char *data = table.data();
+    uint64_t count, offset;
+    if(name == "/" || name == "/SYM64/") {
+        // GNU and the first COFF linker member: count, offsets, then the names
+        int bytes = name == "/" ? 4 : 8;
+        if(table.size() < size_t(bytes)) return;
+        count = readBE(data, bytes);
+        if(count > table.size() / bytes - 1) return;
+        offset = bytes * (count + 1);
+        for(uint64_t i = 0; i < count && offset < table.size(); i++) {
+            std::string_view symbol = cString(table, offset);
+            symbols.insert(std::string(symbol));
+            offset += symbol.length() + 1;
+        }
+        return;
+    }
+    // BSD: entries of string offset and member offset, then the strings
+    int bytes = name.find("_64") != std::string_view::npos ? 8 : 4;
+    if(table.size() < size_t(bytes)) return;
+    uint64_t size = readLE(data, bytes);
+    if(size > table.size() - 2 * bytes) return;
+    std::string_view strings = table.substr(2 * bytes + size);
+    if(readLE(data + bytes + size, bytes) < strings.size())
+        strings = strings.substr(0, readLE(data + bytes + size, bytes));
+    for(offset = bytes; offset + 2 * bytes <= size + bytes; offset += 2 * bytes) {
+        std::string_view symbol = cString(strings, readLE(data + offset, bytes));
+        if(symbol != "") symbols.insert(std::string(symbol));
+    }
+}
+
+// the global symbols an ELF or COFF object uses without defining them,
+// and optionally the ones it defines
+void objectSymbols(std::string_view object, std::vector<std::string_view> &undefined,
+                   std::vector<std::string_view> *defined = nullptr) {
+    const char *data = object.data();
+    size_t size = object.size();
+    if(startsWith(object, "\x7f"
+                          "ELF")) {
+        // only little endian, which is all wxWidgets is built for
+        if(size < 64 || object[5] != 1) return;
+        bool is64 = object[4] == 2;
+        uint64_t sections = readLE(data + (is64 ? 0x28 : 0x20), is64 ? 8 : 4),
+                 entrySize = readLE(data + (is64 ? 0x3a : 0x2e), 2),
+                 count = readLE(data + (is64 ? 0x3c : 0x30), 2);
+        if(entrySize < (is64 ? 64u : 40u) || sections > size || count > (size - sections) / entrySize)
+            return;
+        auto section = [&](uint64_t i, uint64_t &offset, uint64_t &length) {
+            const char *header = data + sections + i * entrySize;
+            offset = readLE(header + (is64 ? 24 : 16), is64 ? 8 : 4);
+            length = readLE(header + (is64 ? 32 : 20), is64 ? 8 : 4);
+            if(offset > size || length > size - offset) length = 0;
+        };
+        for(uint64_t i = 0; i < count; i++) {
+            const char *header = data + sections + i * entrySize;
+            // SHT_SYMTAB and its string table
+            if(readLE(header + 4, 4) != 2) continue;
+            uint64_t link = readLE(header + (is64 ? 40 : 24), 4), offset, length, stroff, strlength;
+            if(link >= count) return;
+            section(i, offset, length);
+            section(link, stroff, strlength);
+            std::string_view strings = object.substr(stroff, strlength);
+            size_t symbolSize = is64 ? 24 : 16;
+            for(uint64_t pos = offset + symbolSize; pos + symbolSize <= offset + length;
+                pos += symbolSize) {
+                const char *symbol = data + pos;
+                unsigned char binding = static_cast<unsigned char>(symbol[is64 ? 4 : 12]) >> 4;
+                bool isDefined = readLE(symbol + (is64 ? 6 : 14), 2) != 0;
+                std::string_view name = cString(strings, readLE(symbol, 4));
+                // STB_GLOBAL, weak references can stay unresolved but weak definitions count
+                if(name == "" || binding == 0 || binding > 2) continue;
+                if(!isDefined && binding == 1) {
+                    undefined.push_back(name);
+                } else if(isDefined && defined) {
+                    defined->push_back(name);
+                }
+            }
+        }
+        return;
+    }
+    // COFF, either regular or the bigobj header MinGW uses for large files,
+    // which has the section count at 44 and the symbol table after it
+    bool big = size >= 56 && readLE(data, 2) == 0 && readLE(data + 2, 2) == 0xffff;
+    if(size < 20 || (big && readLE(data + 4, 2) < 2)) return;
+    uint64_t machine = readLE(data + (big ? 6 : 0), 2), table = readLE(data + (big ? 48 : 8), 4),
+             count = readLE(data + (big ? 52 : 12), 4), symbolSize = big ? 20 : 18;
+    if(machine != 0x14c && machine != 0x8664 && machine != 0xaa64 && machine != 0x1c4) return;
+    if(table > size || count > (size - table) / symbolSize) return;
+    std::string_view strings = object.substr(table + count * symbolSize);
+    for(uint64_t i = 0; i < count; i++) {
+        const char *symbol = data + table + i * symbolSize;
+        int64_t number = big ? int32_t(readLE(symbol + 12, 4)) : int16_t(readLE(symbol + 12, 2));
+        // IMAGE_SYM_CLASS_EXTERNAL, undefined unless it has a section or a common size
+        if(symbol[symbolSize - 2] == 2) {
+            std::string_view name = readLE(symbol, 4) == 0
+                                        ? cString(strings, readLE(symbol + 4, 4))
+                                        : cString(std::string_view(symbol, 8), 0);
+            bool isDefined = number != 0 || readLE(symbol + 8, 4) != 0;
+            if(name != "" && !isDefined) {
+                undefined.push_back(name);
+            } else if(name != "" && defined) {
+                defined->push_back(name);
+            }
+        }
+        i += static_cast<unsigned char>(symbol[symbolSize - 1]);
+    }
+}
+
+// the index file: a stamp of the archives, the archive names, which archive needs which,
+// the symbols each defines sorted by name and the symbols each needs from elsewhere
+// sorted by archive, so a lookup reads it in place
+std::string buildArchiveIndex(const Build &build, const std::vector<std::string> &archives,
+                              const std::string &stamp) {
+    std::vector<std::pair<std::string, uint32_t>> symbols;
+    std::vector<std::set<std::string>> needs(archives.size());
+    for(uint32_t i = 0; i < archives.size(); i++) {
+        MappedFile file(build.wxwin + "/lib/" + archives[i]);
+        std::set<std::string> defined;
+        bool indexed = false;
+        forEachMember(std::string_view(file.data, file.size), [&](std::string_view name,
+                                                                  std::string_view data) {
+            if(isSymbolTable(name)) {
+                // COFF archives have a second table with the same symbols
+                if(!indexed) tableSymbols(name, data, defined);
+                indexed = true;
+                return;
+            }
+            std::vector<std::string_view> undefined;
+            objectSymbols(data, undefined);
+            for(std::string_view symbol : undefined) needs[i].insert(std::string(symbol));
+        });
+        if(!indexed) std::cerr << "Warning: " << archives[i] << " has no symbol table" << std::endl;
+        for(const std::string &symbol : defined) {
+            needs[i].erase(symbol);
+            symbols.push_back({symbol, i});
+        }
+    }
+    std::sort(symbols.begin(), symbols.end());
+    // inline functions and templates are defined in many archives, only a symbol
+    // that exactly one archive defines says that archive is needed
+    std::set<std::pair<uint32_t, uint32_t>> edges;
+    std::vector<std::pair<uint32_t, std::string>> externals;
+    for(uint32_t i = 0; i < archives.size(); i++) {
+        for(const std::string &symbol : needs[i]) {
+            auto found = std::lower_bound(symbols.begin(), symbols.end(),
+                                          std::pair<std::string, uint32_t>(symbol, 0));
+            if(found != symbols.end() && found->first == symbol &&
+               (found + 1 == symbols.end() || (found + 1)->first != symbol)) {
+                edges.insert({i, found->second});
+            } else {
+                externals.push_back({i, symbol});
+            }
+        }
+    }
+    std::string out = "wxfidx3\n", strings;
+    std::map<std::string, uint32_t> offsets;
+    auto addString = [&](const std::string &str) {
+        auto found = offsets.find(str);
+        if(found != offsets.end()) return found->second;
+        uint32_t offset = strings.size();
+        strings += str;
+        strings.push_back('\0');
+        offsets[str] = offset;
+        return offset;
+    };
+    putLE32(out, stamp.size());
+    out += stamp;
+    putLE32(out, archives.size());
+    for(const std::string &archive : archives) putLE32(out, addString(archive));
+    putLE32(out, edges.size());
+    for(const std::pair<uint32_t, uint32_t> &edge : edges) {
+        putLE32(out, edge.first);
+        putLE32(out, edge.second);
+    }
+    putLE32(out, symbols.size());
+    for(const std::pair<std::string, uint32_t> &symbol : symbols) {
+        putLE32(out, addString(symbol.first));
+        putLE32(out, symbol.second);
+    }
+    putLE32(out, externals.size());
+    for(const std::pair<uint32_t, std::string> &external : externals) {
+        putLE32(out, external.first);
+        putLE32(out, addString(external.second));
+    }
+    putLE32(out, strings.size());
+    return out + strings;
+}
+
+// the index of the archives in WXWIN/lib, everything points into its data
+struct ArchiveIndex {
+    uint32_t archiveCount = 0, edgeCount = 0, symbolCount = 0, externalCount = 0;
+    const char *archives = nullptr, *edges = nullptr, *symbols = nullptr, *externals = nullptr;
+    std::string_view strings;
+    std::unique_ptr<MappedFile> mapped;
+    std::string built;
+
+    // false if the data isn't an index of the archives the stamp describes
+    bool load(std::string_view data, const std::string &stamp) {
+        size_t pos = 8;
+        auto table = [&](size_t entrySize, uint32_t &count, const char *&entries) {
+            if(pos + 4 > data.size()) return false;
+            count = readLE(data.data() + pos, 4);
+            pos += 4;
+            if(count > (data.size() - pos) / entrySize) return false;
+            entries = data.data() + pos;
+            pos += count * entrySize;
+            return true;
+        };
+        uint32_t stampSize, stringSize;
+        const char *stampData, *stringData;
+        if(!startsWith(data, "wxfidx3\n") || !table(1, stampSize, stampData) ||
+           std::string_view(stampData, stampSize) != stamp || !table(4, archiveCount, archives) ||
+           !table(8, edgeCount, edges) || !table(8, symbolCount, symbols) ||
+           !table(8, externalCount, externals) || !table(1, stringSize, stringData))
+            return false;
+        strings = std::string_view(stringData, stringSize);
+        return true;
+    }
+
+    // map the index file, or build it again when the archives changed
+    bool open(const Build &build) {
+        std::vector<std::string> files = libFiles(build, "wx");
+        if(files.empty()) return false;
+        std::string filename = cacheDir(build) + "/archives.index",
+                    stamp = archivesStamp(build, files);
+        mapped.reset(new MappedFile(filename));
+        if(load(std::string_view(mapped->data, mapped->size), stamp)) return true;
+        // Windows can't replace a mapped file
+        mapped.reset();
+        built = buildArchiveIndex(build, files, stamp);
+        createDir(cacheDir(build));
+        writeFileAtomic(filename, built);
+        return load(built, stamp);
+    }
+
+    std::string_view archive(uint32_t i) const { return cString(strings, readLE(archives + 4 * i, 4)); }
+
+    std::string_view symbol(uint32_t i) const { return cString(strings, readLE(symbols + 8 * i, 4)); }
+
+    // the archive -l finds for a library name, -1 if it isn't indexed
+    int find(const std::string &lib) const {
+        for(uint32_t i = 0; i < archiveCount; i++) {
+            if(libName(archive(i)) == lib) return i;
+        }
+        return -1;
+    }
+
+    // the archives that define a symbol
+    std::vector<uint32_t> definers(std::string_view name) const {
+        std::vector<uint32_t> found;
+        uint32_t low = 0, high = symbolCount;
+        while(low < high) {
+            uint32_t middle = low + (high - low) / 2;
+            if(symbol(middle) < name) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        for(; low < symbolCount && symbol(low) == name; low++) {
+            uint32_t archive = readLE(symbols + 8 * low + 4, 4);
+            if(archive < archiveCount) found.push_back(archive);
+        }
+        return found;
+    }
+
+    // which archives each archive needs
+    std::vector<std::vector<uint32_t>> needs() const {
+        std::vector<std::vector<uint32_t>> needs(archiveCount);
+        for(uint32_t i = 0; i < edgeCount; i++) {
+            uint32_t from = readLE(edges + 8 * i, 4), to = readLE(edges + 8 * i + 4, 4);
+            if(from < archiveCount && to < archiveCount) needs[from].push_back(to);
+        }
+        return needs;
+    }
+
+    // the symbols an archive needs that no single other archive defines
+    std::vector<std::string_view> externalsOf(uint32_t archive) const {
+        std::vector<std::string_view> found;
+        uint32_t low = 0, high = externalCount;
+        while(low < high) {
+            uint32_t middle = low + (high - low) / 2;
+            if(readLE(externals + 8 * middle, 4) < archive) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        for(; low < externalCount && readLE(externals + 8 * low, 4) == archive; low++)
+            found.push_back(cString(strings, readLE(externals + 8 * low + 4, 4)));
+        return found;
+    }
+};
+
+// the wx libraries each before the ones it needs, in the places the wx libraries had
+// archives that need each other are grouped, everything appears only once
+// other flags like -Wl,--as-needed or -Wl,-Bstatic stay where they are
+std::string orderLibs(const Build &build, const std::string &libs) {
+    ArchiveIndex index;
+    if(!index.open(build)) return libs;
+    std::vector<std::vector<uint32_t>> needs = index.needs();
+    // rank is the order archives were asked for in, -1 if they aren't used
+    std::vector<int> rank(index.archiveCount, -1);
+    std::vector<uint32_t> used;
+    std::vector<std::string> tokens = flagTokens(libs);
+    // the places of the wx libraries, they get the libraries in their new order
+    std::vector<size_t> slots;
+    for(size_t i = 0; i < tokens.size(); i++) {
+        const std::string &token = tokens[i];
+        if(token == "-Wl,--start-group" || token == "-Wl,--end-group") {
+            tokens[i] = "";
+            continue;
+        }
+        if(!startsWith(token, "-l")) continue;
+        int archive = index.find(token.substr(2));
+        if(archive >= 0) {
+            if(rank[archive] < 0) {
+                rank[archive] = used.size();
+                used.push_back(archive);
+            }
+            slots.push_back(i);
+            continue;
+        }
+        // libraries outside WXWIN/lib stay where they appeared last
+        for(size_t j = 0; j < i; j++) {
+            if(tokens[j] == token) tokens[j] = "";
+        }
+    }
+    // add the archives those need
+    for(size_t i = 0; i < used.size(); i++) {
+        for(uint32_t need : needs[used[i]]) {
+            if(rank[need] >= 0) continue;
+            rank[need] = used.size();
+            used.push_back(need);
+        }
+    }
+    // archives that need each other form one component, components only need earlier ones
+    std::vector<int> component(index.archiveCount, -1), low(index.archiveCount),
+        visited(index.archiveCount, -1);
+    std::vector<uint32_t> path;
+    int visits = 0, components = 0;
+    std::function<void(uint32_t)> visit = [&](uint32_t archive) {
+        visited[archive] = low[archive] = visits++;
+        path.push_back(archive);
+        for(uint32_t need : needs[archive]) {
+            if(visited[need] < 0) {
+                visit(need);
+                low[archive] = std::min(low[archive], low[need]);
+            } else if(component[need] < 0) {
+                low[archive] = std::min(low[archive], visited[need]);
+            }
+        }
+        if(low[archive] != visited[archive]) return;
+        uint32_t member;
+        do {
+            member = path.back();
+            path.pop_back();
+            component[member] = components;
+        } while(member != archive);
+        components++;
+    };
+    for(uint32_t archive : used) {
+        if(visited[archive] < 0) visit(archive);
+    }
+    std::vector<std::vector<uint32_t>> members(components);
+    for(uint32_t archive : used) members[component[archive]].push_back(archive);
+    std::vector<std::set<int>> before(components);
+    std::vector<int> waiting(components, 0);
+    for(uint32_t archive : used) {
+        for(uint32_t need : needs[archive]) {
+            int from = component[archive], to = component[need];
+            if(from != to && before[from].insert(to).second) waiting[to]++;
+        }
+    }
+    std::vector<std::string> ordered;
+    std::vector<bool> done(components, false);
+    for(int i = 0; i < components; i++) {
+        // of the components nothing else waits for, take the one asked for first
+        int next = -1;
+        for(int c = 0; c < components; c++) {
+            if(!done[c] && waiting[c] == 0 &&
+               (next < 0 || rank[members[c][0]] < rank[members[next][0]]))
+                next = c;
+        }
+        done[next] = true;
+        for(int c : before[next]) waiting[c]--;
+        bool group = members[next].size() > 1;
+        for(size_t m = 0; m < members[next].size(); m++) {
+            std::string lib = "-l" + libName(index.archive(members[next][m]));
+            if(group && m == 0) lib = "-Wl,--start-group " + lib;
+            if(group && m + 1 == members[next].size()) lib += " -Wl,--end-group";
+            ordered.push_back(lib);
+        }
+    }
+    // repeated ones leave their place empty, the added ones go after the last
+    for(size_t i = 0; i < slots.size(); i++)
+        tokens[slots[i]] = i < ordered.size() ? ordered[i] : "";
+    for(size_t i = slots.size(); i < ordered.size(); i++) tokens[slots.back()] += " " + ordered[i];
+    std::string out = "";
+    for(const std::string &token : tokens) {
+        if(token != "") out += (out == "" ? "" : " ") + token;
+    }
+    return out + "\n";
+}
+
+// --wxflagsLIBSFOR=<objects> keeps only the libraries the project's objects need
+// objects are separated by ';', @file reads their names from a response file
+std::vector<std::string> objectFiles(const std::string &list) {
+    std::vector<std::string> files;
+    std::istringstream entries(list);
+    std::string entry, content;
+    while(std::getline(entries, entry, ';')) {
+        if(entry.rfind("@", 0) != 0 || !readFile(entry.substr(1), content)) {
+            if(entry != "") files.push_back(entry);
+            continue;
+        }
+        // names are separated by whitespace and may be quoted
+        std::string name = "";
+        bool quoted = false;
+        for(char c : content + "\n") {
+            if(c == '"') {
+                quoted = !quoted;
+            } else if(!quoted && isspace(static_cast<unsigned char>(c))) {
+                if(name != "") files.push_back(name);
+                name = "";
+            } else {
+                name += c;
+            }
+        }
+    }
+    return files;
+}
+
+// where the linker looks for a -l library besides WXWIN/lib
+std::vector<std::string> libraryDirs(const std::vector<std::string> &tokens) {
+    std::vector<std::string> dirs;
+    for(const std::string &token : tokens) {
+        if(startsWith(token, "-L") && token.length() > 2) dirs.push_back(token.substr(2));
+    }
+    const char *path = getenv("LIBRARY_PATH");
+    std::istringstream paths(path ? path : "");
+    std::string dir;
+#ifdef _WIN32
+    while(std::getline(paths, dir, ';')) {
+#else
+    while(std::getline(paths, dir, ':')) {
+#endif
+        if(dir != "") dirs.push_back(dir);
+    }
+    // the toolchain's own lib folder next to its bin folder
+    for(const char *compiler : {"gcc", "clang", "cc"}) {
+        std::string program = slashes(findProgram(compiler));
+        size_t pos = program.rfind("/");
+        if(pos == std::string::npos) continue;
+        dirs.push_back(program.substr(0, pos) + "/../lib");
+        break;
+    }
+    return dirs;
+}
+
+// the symbols a library defines and the ones its members need
+struct LinkLibrary {
+    bool found = false;
+    std::set<std::string> defined;
+    std::vector<std::string> undefined;
+};
+
+LinkLibrary readLinkLibrary(const std::string &name, const std::vector<std::string> &dirs) {
+    LinkLibrary library;
+    for(const std::string &dir : dirs) {
+        for(const std::string &file : {"lib" + name + ".dll.a", "lib" + name + ".a", name + ".lib"}) {
+            MappedFile mapped(dir + "/" + file);
+            if(!mapped.open) continue;
+            std::vector<std::string_view> undefined, defined;
+            bool indexed = false;
+            auto onMember = [&](std::string_view member, std::string_view data) {
+                if(isSymbolTable(member)) {
+                    if(!indexed) tableSymbols(member, data, library.defined);
+                    indexed = true;
+                    return;
+                }
+                objectSymbols(data, undefined, &defined);
+            };
+            library.found = forEachMember(std::string_view(mapped.data, mapped.size), onMember);
+            for(std::string_view symbol : defined) library.defined.insert(std::string(symbol));
+            for(std::string_view symbol : undefined) {
+                if(!library.defined.count(std::string(symbol))) library.undefined.emplace_back(symbol);
+            }
+            if(library.found) return library;
+        }
+    }
+    return library;
+}
+
+// drop the libraries of a --libs line that nothing the objects need comes from
+std::string pruneLibs(const Build &build, const std::string &libs, const std::string &list) {
+    // what the objects need from outside
+    std::vector<std::string> pending;
+    std::set<std::string> defined, seen;
+    for(const std::string &filename : objectFiles(list)) {
+        MappedFile mapped(filename);
+        if(!mapped.open) {
+            std::cerr << "Error: Could not open file " << filename << std::endl;
+            return libs;
+        }
+        std::string_view data(mapped.data, mapped.size);
+        std::vector<std::string_view> undefined, symbols;
+        // the project's own static libraries count as objects too
+        auto onMember = [&](std::string_view member, std::string_view object) {
+            if(!isSymbolTable(member)) objectSymbols(object, undefined, &symbols);
+        };
+        if(!forEachMember(data, onMember)) objectSymbols(data, undefined, &symbols);
+        for(std::string_view symbol : symbols) defined.insert(std::string(symbol));
+        for(std::string_view symbol : undefined) pending.emplace_back(symbol);
+    }
+    std::vector<std::string> tokens = flagTokens(libs), dirs = libraryDirs(tokens);
+    ArchiveIndex index;
+    bool indexed = index.open(build);
+    std::vector<std::vector<uint32_t>> needs = index.needs();
+    std::vector<bool> keptArchive(index.archiveCount, false);
+    // the other libraries in link order, read when a symbol is first looked for
+    std::vector<std::string> others;
+    std::map<std::string, LinkLibrary> otherLibs;
+    std::set<std::string> keptOther;
+    std::vector<int> position(index.archiveCount, -1);
+    for(size_t i = 0; i < tokens.size(); i++) {
+        if(!startsWith(tokens[i], "-l")) continue;
+        int archive = indexed ? index.find(tokens[i].substr(2)) : -1;
+        if(archive >= 0 && position[archive] < 0) position[archive] = i;
+        if(archive < 0 && !otherLibs.count(tokens[i].substr(2))) {
+            others.push_back(tokens[i].substr(2));
+            otherLibs[tokens[i].substr(2)];
+        }
+    }
+    std::function<void(uint32_t)> keepArchive = [&](uint32_t archive) {
+        if(keptArchive[archive]) return;
+        keptArchive[archive] = true;
+        for(uint32_t need : needs[archive]) keepArchive(need);
+        for(std::string_view symbol : index.externalsOf(archive)) pending.emplace_back(symbol);
+    };
+    std::set<std::string> read;
+    while(!pending.empty()) {
+        std::string symbol = pending.back();
+        pending.pop_back();
+        if(defined.count(symbol) || !seen.insert(symbol).second) continue;
+        std::vector<uint32_t> archives = indexed ? index.definers(symbol) : std::vector<uint32_t>();
+        if(!archives.empty()) {
+            // any archive already kept will do, otherwise the one listed first
+            uint32_t best = archives[0];
+            for(uint32_t archive : archives) {
+                if(keptArchive[archive]) {
+                    best = archive;
+                    break;
+                }
+                if(position[archive] >= 0 && (position[best] < 0 || position[archive] < position[best]))
+                    best = archive;
+            }
+            keepArchive(best);
+            continue;
+        }
+        for(const std::string &name : others) {
+            LinkLibrary &library = otherLibs[name];
+            if(read.insert(name).second) library = readLinkLibrary(name, dirs);
+            if(!library.defined.count(symbol)) continue;
+            if(keptOther.insert(name).second) {
+                for(const std::string &need : library.undefined) pending.push_back(need);
+            }
+            break;
+        }
+    }
+    std::string out = "", dropped = "";
+    for(const std::string &token : tokens) {
+        bool drop = false;
+        if(startsWith(token, "-l")) {
+            std::string name = token.substr(2);
+            int archive = indexed ? index.find(name) : -1;
+            if(archive >= 0) {
+                drop = !keptArchive[archive];
+            } else {
+                // libraries that couldn't be found are kept
+                if(read.insert(name).second) otherLibs[name] = readLinkLibrary(name, dirs);
+                drop = otherLibs[name].found && !keptOther.count(name);
+            }
+        }
+        if(drop) {
+            dropped += " " + token;
+        } else {
+            out += token + " ";
+        }
+    }
+    if(dropped != "") std::cerr << "Dropped:" << dropped << std::endl;
+    strstrip(out);
+    return out + "\n";
+}
+
+// where the server collects what a thread writes to std::cerr for the request it answers
+thread_local std::string *requestErrors = nullptr;
+
+// flags of each category from one wx-config run, or none in native mode
+// returns the exit status of wx-config
+int resolveSections(const Build &build, int argc, char *argv[], const std::string &command,
+                    const std::vector<Category> &categories, bool native,
+                    std::map<Category, std::string> &sections) {
+    bool custom = isCustom(argc, argv), fastLink = hasFlag(argc, argv, "--wxflagsFASTLINK");
+    int status = 0;
+    if(native) {
+        // the native flags come from build.cfg
+        createBuildCfg(build, fastLink);
+        for(Category category : categories) {
+            sections[category] = nativeFlags(build, category, custom);
+            if(sections[category] == "") status = 1;
+        }
+        return status;
+    }
+    // build.cfg is checked, and setup.h and the libraries it adds are read, once wx-config runs
+    // and while it does, wx-config only runs again in the rare case build.cfg changed under it
+    std::string libs, output, version = wxVersion(build);
+    bool addsLibs = std::find(categories.begin(), categories.end(), LIBS) != categories.end(),
+         changed = false;
+    auto prepare = [&] {
+        changed = createBuildCfg(build, fastLink);
+        if(addsLibs) libs = addLibs(build, custom);
+    };
+    // without build.cfg wx-config has nothing to read yet
+    if(!fileExists(cfgDir(build) + "/build.cfg")) createBuildCfg(build, fastLink);
+    std::thread helper;
+    std::function<void()> onStarted = [&] {
+        helper = std::thread([&, errors = requestErrors] {
+            requestErrors = errors;
+            prepare();
+        });
+    };
+    auto run = [&](const std::function<void(std::string_view)> &onOutput) {
+        TraceScope trace("wxconfig");
+        ProcessResult result =
+            runProcess(command, onOutput, build.timeout, onStarted, build.environment);
+        if(onStarted) {
+            // it never started if wx-config couldn't
+            if(helper.joinable()) {
+                helper.join();
+            } else {
+                prepare();
+            }
+            onStarted = nullptr;
+        }
+        return result;
+    };
+    ProcessResult result;
+    if(categories.size() == 1) {
+        // rewrite the output while wx-config is still writing it
+        Category category = categories[0];
+        auto stream = [&] {
+            StreamRewriter rewriter =
+                category == LIBS
+                    ? StreamRewriter(libRules, sizeof(libRules) / sizeof(libRules[0]), version)
+                    : StreamRewriter(includeRules, sizeof(includeRules) / sizeof(includeRules[0]),
+                                     "");
+            result = run([&](std::string_view chunk) { rewriter.feed(chunk); });
+            // most of the rewriting already happened within wxconfig's span
+            TraceScope trace(category == LIBS ? "fixLibs" : "fixInclude");
+            rewriter.finish();
+            return std::move(rewriter.out);
+        };
+        std::string out = stream();
+        if(changed) out = stream();
+        status = wxconfigStatus(build, result);
+        if(category == LIBS) finishLibs(out, libs);
+        sections[category] = std::move(out);
+        return status;
+    }
+    result = run([&](std::string_view chunk) { output.append(chunk); });
+    if(changed) {
+        output.clear();
+        result = run([&](std::string_view chunk) { output.append(chunk); });
+    }
+    status = wxconfigStatus(build, result);
+    sections = splitCategories(output, categories);
+    // fix the output of wx-config
+    for(Category category : categories) {
+        if(category == LIBS) {
+            sections[category] = fixLibs(sections[category], libs, version);
+        } else {
+            sections[category] = fixInclude(sections[category]);
+        }
+    }
+    return status;
+}
+
+// --wxflagsCANONICAL prints the same flags the same way on every machine, since compiler
+// caches key on the exact command line: / in paths, no duplicate folders or defines, sorted
+// defines, single spaces and --wxflagsBASE=<dir> makes paths inside dir relative to it
+std::vector<std::string> pathParts(const std::string &path) {
+    std::vector<std::string> parts;
+    std::istringstream stream(path);
+    std::string part;
+    while(std::getline(stream, part, '/')) {
+        if(part == "" || part == ".") continue;
+        // a drive can't be left
+        if(part == ".." && !parts.empty() && parts.back() != ".." && parts.back().back() != ':') {
+            parts.pop_back();
+            continue;
+        }
+        parts.push_back(part);
+    }
+    return parts;
+}
+
+std::string canonicalPath(const std::string &path, const std::string &base) {
+    std::string temp = slashes(path), root = "";
+#ifdef _WIN32
+    // Windows paths ignore case
+    temp = toLowerCase(temp);
+#endif
+    if(temp.rfind("//", 0) == 0) {
+        root = "//";
+    } else if(temp.rfind("/", 0) == 0) {
+        root = "/";
+    }
+    std::vector<std::string> parts = pathParts(temp), baseParts;
+    if(base != "") {
+        std::string baseRoot = slashes(base);
+#ifdef _WIN32
+        baseRoot = toLowerCase(baseRoot);
+#endif
+        baseParts = pathParts(baseRoot);
+        baseRoot = baseRoot.rfind("//", 0) == 0 ? "//" : (baseRoot.rfind("/", 0) == 0 ? "/" : "");
+        // only paths that share the root and the drive with the base
+        if(baseRoot != root || baseParts.empty() || parts.empty() || baseParts[0] != parts[0])
+            baseParts.clear();
+    }
+    size_t common = 0;
+    while(common < baseParts.size() && common < parts.size() && baseParts[common] == parts[common])
+        common++;
+    temp = baseParts.empty() ? root : "";
+    for(size_t i = common; i < baseParts.size(); i++) temp += "../";
+    for(size_t i = common; i < parts.size(); i++) temp += parts[i] + "/";
+    if(temp.length() > root.length() && temp.back() == '/') temp.pop_back();
+    return temp == "" ? "." : temp;
+}
+
+std::string canonicalFlags(const std::string &flags, const std::string &base) {
+    std::vector<std::string> tokens = flagTokens(flags), out, defines;
+    std::set<std::string> seen;
+    size_t definesAt = std::string::npos;
+    for(size_t i = 0; i < tokens.size(); i++) {
+        std::string token = tokens[i];
+        if(token == "-isystem" && i + 1 < tokens.size()) token += " " + tokens[++i];
+        bool folder = false;
+        for(const char *prefix : {"-I", "-L", "--include-dir ", "-isystem ", "-isystem"}) {
+            size_t length = strlen(prefix);
+            if(token.length() > length && token.compare(0, length, prefix) == 0) {
+                token = prefix + canonicalPath(token.substr(length), base);
+                folder = true;
+                break;
+            }
+        }
+        if(startsWith(token, "-D") || startsWith(token, "--define ")) {
+            if(definesAt == std::string::npos) definesAt = out.size();
+            defines.push_back(token);
+        } else if(!folder || seen.insert(token).second) {
+            // libraries and linker options like -Wl,--start-group or -Wl,-Bstatic depend on
+            // where they are, they stay even when they appear twice
+            out.push_back(token);
+        }
+    }
+    std::sort(defines.begin(), defines.end());
+    defines.erase(std::unique(defines.begin(), defines.end()), defines.end());
+    if(definesAt != std::string::npos)
+        out.insert(out.begin() + std::min(definesAt, out.size()), defines.begin(), defines.end());
+    std::string temp = "";
+    for(const std::string &token : out) temp += (temp == "" ? "" : " ") + token;
+    return temp;
+}
+
+// --wxflagsFASTLINK adds the fastest link options the probed toolchain takes: mold or lld and
+// a ThinLTO cache, --gc-sections for release builds and split DWARF for debug builds, which
+// keeps the debug info out of the link
+// the build type is wx-config's --debug= if the query has it, BUILD of build.cfg otherwise
+void addFastLink(const Build &build, int argc, char *argv[],
+                 std::map<Category, std::string> &sections) {
+    const Toolchain &tools = toolchain(build);
+    std::string type = flagValue(argc, argv, "--debug=");
+    bool debug = type != "" ? type != "no" : readBuildCfg(build)["BUILD"] == "debug";
+    if(sections.count(LIBS)) {
+        std::string &libs = sections[LIBS];
+        strstrip(libs);
+        if(tools.mold) {
+            libs += " -fuse-ld=mold";
+        } else if(tools.lld) {
+            libs += " -fuse-ld=lld";
+        }
+        // the cache only does something for ThinLTO links
+        if(tools.thinLto)
+            libs += " -flto=thin -Wl,--thinlto-cache-dir=" + cacheDir(build) + "/thinlto";
+        if(!debug && tools.gcSections) libs += " -Wl,--gc-sections";
+        libs += "\n";
+    }
+    if(sections.count(CFLAGS) && debug && tools.splitDwarf) {
+        std::string &cflags = sections[CFLAGS];
+        strstrip(cflags);
+        cflags += " -gsplit-dwarf\n";
+    }
+}
+
+std::string jsonEscape(const std::string &str) {
+    std::string temp = "";
+    for(char c : str) {
+        if(c == '"' || c == '\\') temp += '\\';
+        temp += c;
+    }
+    return temp;
+}
+
+// the folder of an include flag, empty for other flags
+std::string includeDir(const std::string &token) {
+    for(const char *prefix : {"-I", "--include-dir "}) {
+        size_t length = strlen(prefix);
+        if(token.length() > length && token.compare(0, length, prefix) == 0)
+            return token.substr(length);
+    }
+    return "";
+}
+
+// --wxflagsMININCLUDE drops include folders that don't exist or repeat an earlier one
+// the compiler looks in each of them for every header that isn't found before it
+std::string minimizeIncludes(const std::string &flags) {
+    std::vector<std::string> tokens = flagTokens(flags);
+    std::set<std::string> seen;
+    std::string temp = "", dropped = "";
+    for(size_t i = 0; i < tokens.size(); i++) {
+        std::string token = tokens[i];
+        if(token == "-I" && i + 1 < tokens.size()) token += tokens[++i];
+        std::string dir = includeDir(token);
+        if(dir != "" && (!dirExists(dir) || !seen.insert(canonicalPath(dir, "")).second)) {
+            dropped += " " + dir;
+            continue;
+        }
+        temp += (temp == "" ? "" : " ") + token;
+    }
+    if(dropped != "") std::cerr << "Dropped:" << dropped << std::endl;
+    return temp + "\n";
+}
+
+// --wxflagsHEADERS=<hmap|vfs>[:<file>] maps every wx/ header to the file the include folders
+// give it, so the compiler finds it with one lookup instead of trying each folder in turn
+// hmap writes a clang header map (wx.hmap) for -I, vfs a clang VFS overlay (wx-vfs.yaml) for
+// -ivfsoverlay, the include folders stay behind it for everything else
+
+// the headers under dir/sub, as paths relative to dir
+void listHeaders(const std::string &dir, const std::string &sub, std::vector<std::string> &headers) {
+    std::vector<std::pair<std::string, bool>> entries;
+#ifdef _WIN32
+    WIN32_FIND_DATA data;
+    HANDLE find = FindFirstFile((dir + "/" + sub + "/*").c_str(), &data);
+    if(find == INVALID_HANDLE_VALUE) return;
+    do {
+        entries.push_back({data.cFileName, (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0});
+    } while(FindNextFile(find, &data));
+    FindClose(find);
+#else
+    DIR *folder = opendir((dir + "/" + sub).c_str());
+    if(!folder) return;
+    while(dirent *entry = readdir(folder)) {
+        struct stat info;
+        if(stat((dir + "/" + sub + "/" + entry->d_name).c_str(), &info) == 0)
+            entries.push_back({entry->d_name, S_ISDIR(info.st_mode)});
+    }
+    closedir(folder);
+#endif
+    for(const std::pair<std::string, bool> &entry : entries) {
+        const std::string &name = entry.first;
+        if(name == "." || name == "..") continue;
+        if(entry.second) {
+            listHeaders(dir, sub + "/" + name, headers);
+        } else if(name.length() > 2 && toLowerCase(name.substr(name.length() - 2)) == ".h") {
+            headers.push_back(sub + "/" + name);
+        }
+    }
+}
+
+// include name -> file, the first folder that has a header wins like it does for the compiler
+std::map<std::string, std::string> wxHeaders(const std::string &flags) {
+    std::map<std::string, std::string> headers;
+    std::vector<std::string> tokens = flagTokens(flags);
+    for(size_t i = 0; i < tokens.size(); i++) {
+        std::string token = tokens[i];
+        if(token == "-I" && i + 1 < tokens.size()) token += tokens[++i];
+        std::string dir = includeDir(token);
+        if(dir == "") continue;
+        std::vector<std::string> names;
+        listHeaders(slashes(dir), "wx", names);
+        for(const std::string &name : names) {
+#ifdef _WIN32
+            // Windows finds headers in any case
+            std::string key = toLowerCase(name);
+#else
+            std::string key = name;
+#endif
+            if(!headers.count(key)) headers[key] = slashes(dir) + "/" + name;
+        }
+    }
+    return headers;
+}
+
+// clang's header map: a header, a hash table of key, prefix and suffix string offsets with
+// linear probing on the sum of the lower case characters times 13, and the strings
+std::string headerMap(const std::map<std::string, std::string> &headers) {
+    uint32_t buckets = 2;
+    while(buckets < headers.size() * 2) buckets *= 2;
+    std::vector<uint32_t> table(buckets * 3, 0);
+    std::map<std::string, uint32_t> offsets;
+    std::string strings(1, '\0'); // offset 0 is no string
+    auto addString = [&](const std::string &str) {
+        if(!offsets.count(str)) {
+            offsets[str] = strings.size();
+            strings += str;
+            strings.push_back('\0');
+        }
+        return offsets[str];
+    };
+    size_t maxValue = 0;
+    for(const std::pair<const std::string, std::string> &header : headers) {
+        uint32_t hash = 0;
+        for(char c : header.first) hash += tolower((unsigned char)c) * 13;
+        uint32_t bucket = hash & (buckets - 1);
+        while(table[bucket * 3] != 0) bucket = (bucket + 1) & (buckets - 1);
+        size_t split = header.second.rfind('/') + 1;
+        table[bucket * 3] = addString(header.first);
+        table[bucket * 3 + 1] = addString(header.second.substr(0, split));
+        table[bucket * 3 + 2] = addString(header.second.substr(split));
+        maxValue = std::max(maxValue, header.second.length());
+    }
+    std::string out;
+    putLE32(out, 0x686D6170); // "pamh"
+    putLE32(out, 1);          // version 1, reserved 0
+    putLE32(out, 24 + buckets * 12);
+    putLE32(out, headers.size());
+    putLE32(out, buckets);
+    putLE32(out, maxValue);
+    for(uint32_t value : table) putLE32(out, value);
+    return out + strings;
+}
+
+// clang's VFS overlay: the headers as files of a virtual folder, one root per wx/ subfolder
+std::string vfsOverlay(const std::map<std::string, std::string> &headers, const std::string &root) {
+    std::map<std::string, std::vector<const std::pair<const std::string, std::string> *>> dirs;
+    for(const std::pair<const std::string, std::string> &header : headers)
+        dirs[header.first.substr(0, header.first.rfind('/'))].push_back(&header);
+#ifdef _WIN32
+    std::string temp = "{\n  \"version\": 0,\n  \"case-sensitive\": \"false\",\n  \"roots\": [";
+#else
+    std::string temp = "{\n  \"version\": 0,\n  \"case-sensitive\": \"true\",\n  \"roots\": [";
+#endif
+    bool firstDir = true;
+    for(const auto &dir : dirs) {
+        temp += std::string(firstDir ? "" : ",") + "\n    {\"name\": \"" +
+                jsonEscape(root + "/" + dir.first) + "\", \"type\": \"directory\", \"contents\": [";
+        firstDir = false;
+        for(size_t i = 0; i < dir.second.size(); i++) {
+            const std::string &name = dir.second[i]->first;
+            temp += std::string(i == 0 ? "" : ",") + "\n      {\"name\": \"" +
+                    jsonEscape(name.substr(name.rfind('/') + 1)) +
+                    "\", \"type\": \"file\", \"external-contents\": \"" +
+                    jsonEscape(dir.second[i]->second) + "\"}";
+        }
+        temp += "\n    ]}";
+    }
+    return temp + "\n  ]\n}\n";
+}
+
+// writes the map and puts the flags that use it before the include folders
+// returns false if it couldn't be written
+bool addHeaderMap(const Build &build, const std::string &kind,
+                  std::map<Category, std::string> &sections) {
+    if(!sections.count(CFLAGS)) return true;
+    std::string style = kind.substr(0, kind.find(':')), filename;
+    if(kind.find(':') != std::string::npos) filename = kind.substr(kind.find(':') + 1);
+    if(style != "hmap" && style != "vfs") {
+        std::cerr << "Error: Unknown header map " << style << ", use hmap or vfs" << std::endl;
+        return false;
+    }
+    if(filename == "") filename = style == "hmap" ? "wx.hmap" : "wx-vfs.yaml";
+    std::string &cflags = sections[CFLAGS];
+    std::map<std::string, std::string> headers = wxHeaders(cflags);
+    if(headers.empty()) {
+        std::cerr << "Warning: No wx headers in the include folders, no header map written"
+                  << std::endl;
+        return true;
+    }
+    std::string root = slashes(cacheDir(build)) + "/headers", use;
+    if(style == "hmap") {
+        if(!writeFileIfChanged(filename, headerMap(headers))) {
+            std::cerr << "Error: Could not write " << filename << std::endl;
+            return false;
+        }
+        use = "-I" + filename;
+    } else {
+        if(!writeFileIfChanged(filename, vfsOverlay(headers, root))) {
+            std::cerr << "Error: Could not write " << filename << std::endl;
+            return false;
+        }
+        use = "-ivfsoverlay " + filename + " -I" + root;
+    }
+    cflags = use + " " + cflags;
+    return true;
+}
+
+int querySections(const Build &build, int argc, char *argv[], const std::string &command,
+                  const std::vector<Category> &categories, bool native,
+                  std::map<Category, std::string> &sections) {
+    int status = resolveSections(build, argc, argv, command, categories, native, sections);
+    if(status != 0) return status;
+    if(sections.count(LIBS) && build.wxwin != "") {
+        std::string objects = flagValue(argc, argv, "--wxflagsLIBSFOR=");
+        if(objects != "") sections[LIBS] = pruneLibs(build, sections[LIBS], objects);
+        if(hasFlag(argc, argv, "--wxflagsORDER")) sections[LIBS] = orderLibs(build, sections[LIBS]);
+    }
+    if(hasFlag(argc, argv, "--wxflagsMININCLUDE")) {
+        for(Category category : categories)
+            if(category != LIBS) sections[category] = minimizeIncludes(sections[category]);
+    }
+    std::string headerKind = flagValue(argc, argv, "--wxflagsHEADERS=");
+    if(headerKind != "" && !addHeaderMap(build, headerKind, sections)) return 1;
+    if(hasFlag(argc, argv, "--wxflagsFASTLINK")) addFastLink(build, argc, argv, sections);
+    if(hasFlag(argc, argv, "--wxflagsCANONICAL")) {
+        std::string base = flagValue(argc, argv, "--wxflagsBASE=");
+        for(Category category : categories)
+            sections[category] = canonicalFlags(sections[category], base);
+    }
+    return status;
+}
+
+// plain output is what wx-config would print, the other formats keep the categories apart
+std::string formatSections(int argc, char *argv[], const std::vector<Category> &categories,
+                           std::map<Category, std::string> &sections) {
+    bool json = hasFlag(argc, argv, "--wxflagsJSON"), nul = hasFlag(argc, argv, "--wxflagsNUL");
+    if(!json && !nul && categories.size() == 1) return sections[categories[0]] + "\n";
+    std::string temp = json ? "{" : "";
+    for(size_t i = 0; i < categories.size(); i++) {
+        std::string flags = sections[categories[i]];
+        strstrip(flags);
+        if(json) {
+            if(i > 0) temp += ", ";
+            temp += std::string("\"") + categoryName(categories[i]) + "\": \"" + jsonEscape(flags) +
+                    "\"";
+        } else if(nul) {
+            temp += flags;
+            temp.push_back('\0');
+        } else {
+            if(i > 0) temp += " ";
+            temp += flags;
+        }
+    }
+    if(json) temp += "}";
+    if(!nul) temp += "\n";
+    return temp;
+}
+
+// compare the native flags against the rewritten wx-config output
+int verifyNative(const Build &build, int argc, char *argv[], const std::string &command) {
+    std::vector<Category> categories = getCategories(argc, argv);
+    if(categories.empty()) return 1;
+    std::map<Category, std::string> native, wxconfig;
+    querySections(build, argc, argv, command, categories, true, native);
+    querySections(build, argc, argv, command, categories, false, wxconfig);
+    int differences = 0;
+    for(Category category : categories) {
+        std::vector<std::string> nativeTokens = flagTokens(native[category]),
+                                 tokens = flagTokens(wxconfig[category]);
+        std::multiset<std::string> nativeSet(nativeTokens.begin(), nativeTokens.end()),
+            wxconfigSet(tokens.begin(), tokens.end());
+        std::string name = categoryName(category);
+        int found = 0;
+        for(const std::string &token : wxconfigSet) {
+            if(!nativeSet.count(token)) {
+                std::cout << name << " missing: " << token << std::endl;
+                found++;
+            }
+        }
+        for(const std::string &token : nativeSet) {
+            if(!wxconfigSet.count(token)) {
+                std::cout << name << " extra: " << token << std::endl;
+                found++;
+            }
+        }
+        // the link line also depends on the order
+        if(found == 0 && category == LIBS && nativeTokens != tokens) {
+            std::cout << "library order differs" << std::endl;
+            found++;
+        }
+        differences += found;
+    }
+    if(differences == 0) std::cout << "native flags match wx-config" << std::endl;
+    return differences == 0 ? 0 : 1;
+}
+
+// run wx-config and fix its output, returns the exit status of wx-config
+int runQuery(const Build &build, int argc, char *argv[], const std::string &command,
+             std::string &output) {
+    std::vector<Category> categories = getCategories(argc, argv);
+    int status;
+    // if dynamic flag is used, or there is nothing to fix
+    if(isDynamic(argc, argv) || categories.empty()) {
+        // run wx-config with no modifications
+        createBuildCfg(build);
+        output = wxconfig(build, command, status);
+        if(!isDynamic(argc, argv)) output += "\n";
+        return status;
+    }
+    if(isLibs(argc, argv)) {
+        // It's not possible to speficy these in different places anymore.
+        if(build.wxwin == "" || build.wxcfg == "") {
+            std::cerr << "Missing either WXWIN or WXCFG or both. Please "
+                         "specify either these environment variables or use "
+                         "--prefix= and --wxcfg= flags. ";
+        }
+    }
+    std::map<Category, std::string> sections;
+    status = querySections(build, argc, argv, command, categories, isNativeQuery(argc, argv),
+                           sections);
+    output = formatSections(argc, argv, categories, sections);
+    return status;
+}
+
+// the query part of the key names the file, the stamps are checked when reading it
+// so a changed setup.h, build.cfg or wx-config simply overwrites the old entry
+std::string cacheQuery(const Build &build, int argc, char *argv[]) {
+    std::string query = build.wxwin + "\n" + build.wxcfg;
+    for(int i = 1; i < argc; i++) {
+        // tracing doesn't change the answer
+        if(std::string(argv[i]).rfind("--wxflagsTRACE", 0) == 0) continue;
+        query += std::string("\n") + argv[i];
+    }
+    // the server's clients each bring their own
+    for(const std::string &variable : build.environment) query += "\n" + variable;
+    return query;
+}
+
+// whether an answer depends on the archives in WXWIN/lib
+bool readsArchives(int argc, char *argv[]) {
+    return hasFlag(argc, argv, "--wxflagsORDER") || isNativeQuery(argc, argv);
+}
+
+// the archives in WXWIN/lib count for --wxflagsORDER and native answers, the compiler for
+// --wxflagsFASTLINK
+std::string cacheStamps(const Build &build, int argc, char *argv[]) {
+    std::string stamps = fileStamp(cfgDir(build) + "/wx/setup.h") + "\n" +
+                         fileStamp(cfgDir(build) + "/build.cfg") + "\n" +
+                         fileStamp(findWxConfig(build));
+    if(readsArchives(argc, argv)) stamps += "\n" + archivesStamp(build, libFiles(build, "wx"));
+    if(hasFlag(argc, argv, "--wxflagsFASTLINK")) stamps += "\n" + toolchainIdentity(build);
+    return stamps;
+}
+
+// hits and misses are only counted while WXFLAGS_CACHESTATS is set, so regular runs don't
+// take another lock
+bool countingCache() {
+    const char *stats = getenv("WXFLAGS_CACHESTATS");
+    return stats && *stats && strcmp(stats, "0") != 0;
+}
+
+// the hits and the misses, "0 0" when nothing was counted yet
+void readCacheStats(const Build &build, unsigned long long &hits, unsigned long long &misses) {
+    std::string stats;
+    hits = misses = 0;
+    if(!readFile(cacheDir(build) + "/stats", stats)) return;
+    std::istringstream counters(stats);
+    if(!(counters >> hits >> misses)) hits = misses = 0;
+}
+
+// the counters stay two numbers, concurrent runs update them one at a time
+void cacheCount(const Build &build, bool hit) {
+    if(!countingCache()) return;
+    FileLock lock(cacheDir(build) + "/stats.lock", build.timeout);
+    unsigned long long hits, misses;
+    readCacheStats(build, hits, misses);
+    (hit ? hits : misses)++;
+    writeFileAtomic(cacheDir(build) + "/stats",
+                    std::to_string(hits) + " " + std::to_string(misses) + "\n");
+}
+
+bool readCache(const Build &build, const std::string &query, const std::string &stamps,
+               std::string &output) {
+    std::string content, key = query + "\n" + stamps;
+    if(!readFile(cacheDir(build) + "/" + toHex(fnv1a(query)), content)) return false;
+    // stale or colliding entries have a different key
+    if(content.size() <= key.length() || content.compare(0, key.length(), key) != 0 ||
+       content[key.length()] != '\0')
+        return false;
+    output = content.substr(key.length() + 1);
+    return true;
+}
+
+void writeCache(const Build &build, const std::string &query, const std::string &stamps,
+                const std::string &output) {
+    createDir(cacheDir(build));
+    std::string content = query + "\n" + stamps;
+    content.push_back('\0');
+    writeFileAtomic(cacheDir(build) + "/" + toHex(fnv1a(query)), content + output);
+}
+
+void printCacheStats(const Build &build) {
+    unsigned long long hits, misses;
+    readCacheStats(build, hits, misses);
+    std::cout << "hits: " << hits << " misses: " << misses;
+    if(hits + misses > 0) std::cout << " hit rate: " << (100 * hits / (hits + misses)) << "%";
+    std::cout << std::endl;
+    if(!countingCache())
+        std::cerr << "Note: set WXFLAGS_CACHESTATS=1 for the runs that should be counted"
+                  << std::endl;
+}
+
+// answer from the cache if possible, run the query and remember it otherwise
+int cachedQuery(const Build &build, int argc, char *argv[], const std::string &command,
+                std::string &output) {
+    // the objects of --wxflagsLIBSFOR and the include folders of --wxflagsMININCLUDE and
+    // --wxflagsHEADERS change without the arguments changing
+    bool cache = !hasFlag(argc, argv, "--wxflagsNOCACHE") &&
+                 flagValue(argc, argv, "--wxflagsLIBSFOR=") == "" &&
+                 !hasFlag(argc, argv, "--wxflagsMININCLUDE") &&
+                 flagValue(argc, argv, "--wxflagsHEADERS=") == "" && build.wxwin != "" &&
+                 build.wxcfg != "";
+    if(!cache) return runQuery(build, argc, argv, command, output);
+    std::string query = cacheQuery(build, argc, argv), stamps = cacheStamps(build, argc, argv);
+    if(readCache(build, query, stamps, output)) {
+        cacheCount(build, true);
+        return 0;
+    }
+    // concurrent runs of the same query wait for the first one and read its answer
+    createDir(cacheDir(build));
+    FileLock lock(cacheDir(build) + "/" + toHex(fnv1a(query)) + ".lock", build.timeout);
+    if(readCache(build, query, stamps, output)) {
+        cacheCount(build, true);
+        return 0;
+    }
+    cacheCount(build, false);
+    int status = runQuery(build, argc, argv, command, output);
+    // the answer goes with build.cfg as the query left it, unless setup.h changed meanwhile
+    std::string after = cacheStamps(build, argc, argv);
+    bool moved = after.compare(0, after.find('\n'), stamps, 0, stamps.find('\n')) != 0;
+    // don't remember failures
+    if(status == 0 && !moved) writeCache(build, query, after, output);
+    return status;
+}
+
+std::string cmakeEscape(const std::string &str) {
+    std::string temp = "";
+    for(char c : str) {
+        if(c == '"' || c == '\\' || c == '$') temp += '\\';
+        temp += c;
+    }
+    return temp;
+}
+
+// a CMake list of the tokens starting with prefix, without the prefix
+std::string cmakeList(const std::vector<std::string> &tokens, const std::string &prefix) {
+    std::string temp = "";
+    for(const std::string &token : tokens) {
+        if(token.rfind(prefix, 0) != 0 || token.length() == prefix.length()) continue;
+        if(temp != "") temp += ";";
+        temp += cmakeEscape(token.substr(prefix.length()));
+    }
+    return temp;
+}
+
+// the tokens that don't start with any of the prefixes
+std::string cmakeOthers(const std::vector<std::string> &tokens,
+                        const std::vector<std::string> &prefixes) {
+    std::string temp = "";
+    for(const std::string &token : tokens) {
+        bool other = true;
+        for(const std::string &prefix : prefixes) {
+            if(token.rfind(prefix, 0) == 0) other = false;
+        }
+        if(!other) continue;
+        if(temp != "") temp += ";";
+        temp += cmakeEscape(token);
+    }
+    return temp;
+}
+
+// an imported wx::wx target
+std::string exportCMake(std::map<Category, std::string> &sections) {
+    std::vector<std::string> cflags = flagTokens(sections[CFLAGS]),
+                             libs = flagTokens(sections[LIBS]);
+    std::string rcflags = sections[RCFLAGS];
+    strstrip(rcflags);
+    return "# generated by wx-flags, do not edit\n"
+           "if(NOT TARGET wx::wx)\n"
+           "  add_library(wx::wx INTERFACE IMPORTED)\n"
+           "  set_target_properties(wx::wx PROPERTIES\n"
+           "    INTERFACE_INCLUDE_DIRECTORIES \"" +
+           cmakeList(cflags, "-I") +
+           "\"\n"
+           "    INTERFACE_COMPILE_DEFINITIONS \"" +
+           cmakeList(cflags, "-D") +
+           "\"\n"
+           "    INTERFACE_COMPILE_OPTIONS \"" +
+           cmakeOthers(cflags, {"-I", "-D"}) +
+           "\"\n"
+           "    INTERFACE_LINK_DIRECTORIES \"" +
+           cmakeList(libs, "-L") +
+           "\"\n"
+           "    INTERFACE_LINK_LIBRARIES \"" +
+           cmakeList(libs, "-l") +
+           "\"\n"
+           "    INTERFACE_LINK_OPTIONS \"" +
+           cmakeOthers(libs, {"-L", "-l"}) +
+           "\")\n"
+           "endif()\n"
+           "set(WX_RCFLAGS \"" +
+           cmakeEscape(rcflags) + "\")\n";
+}
+
+// "NAME = value" works as a Makefile and as a Ninja include
+std::string exportMake(std::map<Category, std::string> &sections) {
+    std::string temp = "# generated by wx-flags, do not edit\n";
+    for(Category category : {CFLAGS, RCFLAGS, LIBS}) {
+        std::string flags = sections[category], escaped = "";
+        strstrip(flags);
+        for(char c : flags) {
+            if(c == '$') escaped += '$';
+            escaped += c;
+        }
+        temp += "WX_" + toUpperCase(categoryName(category)) + " = " + escaped + "\n";
+    }
+    return temp;
+}
+
+std::string exportPkgConfig(const Build &build, std::map<Category, std::string> &sections) {
+    std::map<std::string, std::string> cfg = readBuildCfg(build);
+    std::string cflags = sections[CFLAGS], libs = sections[LIBS],
+                version = cfg["WXVER_MAJOR"] + "." + cfg["WXVER_MINOR"] + "." + cfg["WXVER_RELEASE"];
+    strstrip(cflags);
+    strstrip(libs);
+    if(version.length() < 5) version = wxVersion(build);
+    return "# generated by wx-flags, do not edit\n"
+           "prefix=" +
+           slashes(build.wxwin) +
+           "\n\n"
+           "Name: wx\n"
+           "Description: wxWidgets flags resolved by wx-flags\n"
+           "Version: " +
+           version + "\nCflags: " + cflags + "\nLibs: " + libs + "\n";
+}
+
+// --wxflagsEXPORT=<format>[:<file>] resolves everything once and writes it for a build system
+int exportFlags(const Build &build, int argc, char *argv[], const std::string &command) {
+    std::string format = flagValue(argc, argv, "--wxflagsEXPORT="), filename = "";
+    size_t pos = format.find(":");
+    if(pos != std::string::npos) {
+        filename = format.substr(pos + 1);
+        format.erase(pos);
+    }
+    if(format != "cmake" && format != "make" && format != "ninja" && format != "pkgconfig") {
+        std::cerr << "Error: Unknown export format " << format
+                  << ", use cmake, make, ninja or pkgconfig" << std::endl;
+        return 1;
+    }
+    if(filename == "") {
+        if(format == "cmake") {
+            filename = "wx-flags.cmake";
+        } else if(format == "pkgconfig") {
+            filename = "wx.pc";
+        } else {
+            filename = format == "make" ? "wx-flags.mk" : "wx-flags.ninja";
+        }
+    }
+    std::vector<Category> categories = {CFLAGS, RCFLAGS, LIBS};
+    std::map<Category, std::string> sections;
+    int status = querySections(build, argc, argv, command + " --cflags --rcflags --libs",
+                               categories, isNativeQuery(argc, argv), sections);
+    if(status != 0) return status;
+    std::string content;
+    if(format == "cmake") {
+        content = exportCMake(sections);
+    } else if(format == "pkgconfig") {
+        content = exportPkgConfig(build, sections);
+    } else {
+        content = exportMake(sections);
+    }
+    if(!writeFileIfChanged(filename, content)) {
+        std::cerr << "Error opening file for writing!" << std::endl;
+        return 1;
+    }
+    std::cout << filename << std::endl;
+    return 0;
+}
+
+// --wxflagsRSP[=<dir>] replaces the flags with @file, the file is named after their hash
+// so identical flags share one file, which then stays untouched
+bool wantsResponseFile(int argc, char *argv[]) {
+    return hasFlag(argc, argv, "--wxflagsRSP") || flagValue(argc, argv, "--wxflagsRSP=") != "";
+}
+
+// the file goes to dir, or the working folder if it's empty, and only to the cache folder
+// when it can't be written there
+bool toResponseFile(const Build &build, const std::string &dir, std::string &output) {
+    std::string flags = output, content = "";
+    strstrip(flags);
+    for(char c : flags) {
+        // gcc and windres read backslashes in response files as escapes
+        if(c == '\\') content += '\\';
+        content += c;
+    }
+    content += "\n";
+    std::string name = "wx-" + toHex(fnv1a(content)) + ".rsp", filename = name;
+    if(dir != "") {
+        createDir(dir);
+        filename = slashes(dir);
+        if(filename.back() != '/') filename += "/";
+        filename += name;
+    }
+    if(!writeFileIfChanged(filename, content)) {
+        if(build.wxwin == "" || build.wxcfg == "") return false;
+        createDir(cacheDir(build));
+        filename = cacheDir(build) + "/" + name;
+        if(!writeFileIfChanged(filename, content)) return false;
+    }
+    output = "@" + slashes(filename) + "\n";
+    return true;
+}
+
+// print the answer, or a response file holding it
+int printOutput(const Build &build, int argc, char *argv[], std::string &output, int status) {
+    if(status == 0 && hasFlag(argc, argv, "--wxflagsHASH")) {
+        // lets build tools tell a real change of the flags from a new run
+        output = toHex(fnv1a(output)) + "\n";
+    } else if(status == 0 && wantsResponseFile(argc, argv)) {
+        if(hasFlag(argc, argv, "--wxflagsJSON") || hasFlag(argc, argv, "--wxflagsNUL")) {
+            std::cerr << "Error: --wxflagsRSP can't be combined with --wxflagsJSON or --wxflagsNUL"
+                      << std::endl;
+            return 1;
+        }
+        if(!toResponseFile(build, flagValue(argc, argv, "--wxflagsRSP="), output)) {
+            std::cerr << "Error opening file for writing!" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << output;
+    return status;
+}
+
+// --wxflagsPCH=<gcc|clang|msvc>[:<header>] writes a precompiled header with the headers of
+// the components setup.h enables and prints the flags that use it, --wxflagsPCHBUILD
+// prints the flags that build it instead
+std::string pchHeader(const SetupModel &setup) {
+    // a component and the header that brings in most of it
+    std::pair<int, const char *> headers[] = {
+        {setup.aui, "wx/aui/aui.h"},
+        {setup.graphicsContext, "wx/graphics.h"},
+        {setup.html, "wx/html/htmlwin.h"},
+        {setup.mediactrl, "wx/mediactrl.h"},
+        {setup.opengl, "wx/glcanvas.h"},
+        {setup.propgrid, "wx/propgrid/propgrid.h"},
+        {setup.propgrid, "wx/propgrid/advprops.h"},
+        {setup.ribbon, "wx/ribbon/bar.h"},
+        {setup.richtext, "wx/richtext/richtextctrl.h"},
+        {setup.sockets, "wx/socket.h"},
+        {setup.stc, "wx/stc/stc.h"},
+        {setup.webview, "wx/webview.h"},
+        {setup.xml, "wx/xml/xml.h"},
+        {setup.xrc, "wx/xrc/xmlres.h"},
+    };
+    std::string temp = "// generated by wx-flags from setup.h, do not edit\n"
+                       "#ifndef WX_PCH_H\n"
+                       "#define WX_PCH_H\n\n"
+                       "#include <wx/wx.h>\n";
+    for(const std::pair<int, const char *> &header : headers) {
+        if(header.first > 0) temp += std::string("#include <") + header.second + ">\n";
+    }
+    return temp + "\n#endif\n";
+}
+
+int precompiledHeader(const Build &build, int argc, char *argv[]) {
+    std::string style = flagValue(argc, argv, "--wxflagsPCH="), header = "wx_pch.h";
+    size_t pos = style.find(":");
+    if(pos != std::string::npos) {
+        header = style.substr(pos + 1);
+        style.erase(pos);
+    }
+    if(style != "gcc" && style != "clang" && style != "msvc") {
+        std::cerr << "Error: Unknown precompiled header style " << style
+                  << ", use gcc, clang or msvc" << std::endl;
+        return 1;
+    }
+    const SetupModel &setup = setupModel(build);
+    if(!setup.loaded) {
+        std::cerr << "Error: Could not open file " << cfgDir(build) + "/wx/setup.h" << std::endl;
+        return 1;
+    }
+    // unchanged content keeps the old file, so the precompiled header stays valid
+    if(!writeFileIfChanged(header, pchHeader(setup))) {
+        std::cerr << "Error opening file for writing!" << std::endl;
+        return 1;
+    }
+    std::string make, use, base = header.substr(0, header.rfind("."));
+    if(style == "gcc") {
+        // gcc picks up header.gch by itself
+        make = "-x c++-header " + header + " -o " + header + ".gch";
+        use = "-Winvalid-pch -include " + header;
+    } else if(style == "clang") {
+        make = "-x c++-header " + header + " -o " + header + ".pch";
+        use = "-include-pch " + header + ".pch";
+    } else {
+        // cl needs a source file to create it from, it goes in the current folder
+        // so the include is spelled the same as in /Yc, /Yu and /FI
+        std::string source = slashes(base);
+        source = source.substr(source.rfind("/") + 1) + ".cpp";
+        if(!writeFileIfChanged(source, "#include \"" + header + "\"\n")) {
+            std::cerr << "Error opening file for writing!" << std::endl;
+            return 1;
+        }
+        make = "/Yc" + header + " /Fp" + base + ".pch /c " + source;
+        use = "/Yu" + header + " /FI" + header + " /Fp" + base + ".pch";
+    }
+    if(hasFlag(argc, argv, "--wxflagsJSON")) {
+        std::cout << "{\"build\": \"" << jsonEscape(make) << "\", \"use\": \"" << jsonEscape(use)
+                  << "\"}" << std::endl;
+    } else {
+        std::cout << (hasFlag(argc, argv, "--wxflagsPCHBUILD") ? make : use) << std::endl;
+    }
+    return 0;
+}
+
+// --wxflagsBAKE=<out.cpp> resolves every query wx-flags answers for this configuration and
+// writes them into a C++ source, built on its own it's a wx-flags that answers without running
+// anything, and warns once setup.h is no longer the one the answers came from
+
+// a C++ string literal, octal escapes can't run into the next character
+std::string cppString(const std::string &str) {
+    std::string temp = "\"";
+    for(unsigned char c : str) {
+        if(c == '"' || c == '\\') {
+            temp += '\\';
+            temp += c;
+        } else if(c < 32 || c >= 127) {
+            const char *digits = "01234567";
+            temp += '\\';
+            temp += digits[c >> 6];
+            temp += digits[(c >> 3) & 7];
+            temp += digits[c & 7];
+        } else {
+            temp += c;
+        }
+    }
+    return temp + "\"";
+}
+
+// the query part every baked answer is looked up by, the baked main() builds it the same way
+std::string bakeKey(const std::vector<std::string> &categories, bool custom, bool dynamic,
+                    bool json, bool nul) {
+    std::string key;
+    for(const std::string &category : categories) key += " " + category;
+    // the raw output of wx-config doesn't depend on the others
+    if(dynamic) return key + " --wxflagsDYNAMIC";
+    if(custom) key += " --wxflagsCUSTOM";
+    if(json) key += " --wxflagsJSON";
+    if(nul) key += " --wxflagsNUL";
+    return key;
+}
+
+// everything but the answers, these go between the two parts
+const char *bakeHead = R"bake(
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+struct Answer {
+    std::string_view query, output;
+};
+
+)bake";
+
+const char *bakeMain = R"bake(
+std::string fileStamp(const std::string &filename) {
+    std::ostringstream stamp;
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if(!GetFileAttributesEx(filename.c_str(), GetFileExInfoStandard, &data)) return "-";
+    stamp << data.nFileSizeHigh << ":" << data.nFileSizeLow << ":"
+          << data.ftLastWriteTime.dwHighDateTime << ":" << data.ftLastWriteTime.dwLowDateTime;
+#else
+    struct stat info;
+    if(stat(filename.c_str(), &info) != 0) return "-";
+    stamp << info.st_size << ":" << info.st_mtim.tv_sec << ":" << info.st_mtim.tv_nsec;
+#endif
+    return stamp.str();
+}
+
+uint64_t fileHash(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary);
+    std::ostringstream content;
+    content << file.rdbuf();
+    uint64_t hash = 14695981039346656037ULL;
+    for(unsigned char c : content.str()) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// the same folder however it's spelled, WXCFG can also start with a slash
+std::string trimmed(std::string path, bool leading) {
+    while(!path.empty() && strchr("/\\ \t\r\n", path.back())) path.pop_back();
+    while(leading && !path.empty() && strchr("/\\ \t\r\n", path[0])) path.erase(0, 1);
+    return path;
+}
+
+int main(int argc, char **argv) {
+    std::string wxwin = getenv("WXWIN") ? getenv("WXWIN") : bakedWXWIN,
+                wxcfg = getenv("WXCFG") ? getenv("WXCFG") : bakedWXCFG, categories;
+    bool custom = false, dynamic = false, json = false, nul = false;
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg == "--cflags" || arg == "--rcflags" || arg == "--libs") {
+            if(categories.find(" " + arg) == std::string::npos) categories += " " + arg;
+        } else if(arg.rfind("--prefix=", 0) == 0) {
+            wxwin = arg.substr(9);
+        } else if(arg.rfind("--wxcfg=", 0) == 0) {
+            wxcfg = arg.substr(8);
+        } else if(arg == "--wxflagsCUSTOM") {
+            custom = true;
+        } else if(arg == "--wxflagsDYNAMIC") {
+            dynamic = true;
+        } else if(arg == "--wxflagsJSON") {
+            json = true;
+        } else if(arg == "--wxflagsNUL") {
+            nul = true;
+        } else if(arg != "--wxflagsNOCACHE" && arg.rfind("--wxflagsTIMEOUT=", 0) != 0) {
+            fprintf(stderr, "Error: %s wasn't baked in, use wx-flags for it\n", arg.c_str());
+            return 1;
+        }
+    }
+    if(trimmed(wxwin, false) != trimmed(bakedWXWIN, false) ||
+       trimmed(wxcfg, true) != trimmed(bakedWXCFG, true)) {
+        fprintf(stderr, "Error: These flags were baked for %s/lib/%s\n", bakedWXWIN, bakedWXCFG);
+        return 1;
+    }
+    std::string setuph = std::string(bakedWXWIN) + "/lib/" + bakedWXCFG + "/wx/setup.h";
+    // setup.h is only read when its stamp changed
+    if(fileStamp(setuph) != setupStamp && fileHash(setuph) != setupHash)
+        fprintf(stderr, "Warning: %s changed since these flags were baked, bake them again\n",
+                setuph.c_str());
+
+    std::string key = categories;
+    if(dynamic) {
+        key += " --wxflagsDYNAMIC";
+    } else {
+        if(custom) key += " --wxflagsCUSTOM";
+        if(json) key += " --wxflagsJSON";
+        if(nul) key += " --wxflagsNUL";
+    }
+    for(const Answer &answer : answers) {
+        if(answer.query != key) continue;
+        fwrite(answer.output.data(), 1, answer.output.size(), stdout);
+        return 0;
+    }
+    fprintf(stderr, "Error: Nothing was baked for%s, use wx-flags for it\n", key.c_str());
+    return 1;
+}
+)bake";
+
+int bake(const Build &build, int argc, char *argv[]) {
+    std::string filename = flagValue(argc, argv, "--wxflagsBAKE="),
+                setuph = cfgDir(build) + "/wx/setup.h", text;
+    if(!readFile(setuph, text)) {
+        std::cerr << "Error: Could not open file " << setuph << std::endl;
+        return 1;
+    }
+    // every order of the categories, since the output follows it
+    std::vector<std::vector<std::string>> orders;
+    std::vector<std::string> names = {"--cflags", "--libs", "--rcflags"};
+    for(int mask = 1; mask < 8; mask++) {
+        std::vector<std::string> chosen;
+        for(int i = 0; i < 3; i++) {
+            if(mask & (1 << i)) chosen.push_back(names[i]);
+        }
+        do {
+            orders.push_back(chosen);
+        } while(std::next_permutation(chosen.begin(), chosen.end()));
+    }
+    // plain, JSON and NUL output of the default and the custom flags, and the dynamic ones
+    struct Variant {
+        bool custom, dynamic, json, nul;
+    } variants[] = {{false, false, false, false}, {false, false, true, false},
+                    {false, false, false, true},  {true, false, false, false},
+                    {true, false, true, false},   {true, false, false, true},
+                    {false, true, false, false}};
+    bool native = hasFlag(argc, argv, "--wxflagsNATIVE");
+    std::string wxwin = build.wxwin, wxcfg = build.wxcfg, answers;
+    for(const std::vector<std::string> &categories : orders) {
+        for(const Variant &variant : variants) {
+            bool custom = variant.custom, dynamic = variant.dynamic, json = variant.json,
+                 nul = variant.nul;
+            std::vector<std::string> args = {argv[0]};
+            args.insert(args.end(), categories.begin(), categories.end());
+            if(dynamic) args.push_back("--wxflagsDYNAMIC");
+            if(custom) args.push_back("--wxflagsCUSTOM");
+            if(json) args.push_back("--wxflagsJSON");
+            if(nul) args.push_back("--wxflagsNUL");
+            if(native && !dynamic) args.push_back("--wxflagsNATIVE");
+            args.push_back("--prefix=" + wxwin);
+            args.push_back("--wxcfg=" + wxcfg);
+            std::vector<char *> pointers;
+            for(std::string &arg : args) pointers.push_back(&arg[0]);
+            Build baked = build;
+            std::string command = createCommand(pointers.size(), pointers.data(), baked), output;
+            int status = cachedQuery(baked, pointers.size(), pointers.data(), command, output);
+            std::string key = bakeKey(categories, custom, dynamic, json, nul);
+            if(status != 0) {
+                std::cerr << "Error: wx-flags" << key << " failed, nothing was baked" << std::endl;
+                return status;
+            }
+            answers += "    {" + cppString(key) + ", std::string_view(" + cppString(output) + ", " +
+                       std::to_string(output.size()) + ")},\n";
+        }
+    }
+    std::string content = "// generated by wx-flags --wxflagsBAKE, build it on its own as a wx-flags\n"
+                          "// that answers for this wxWidgets build only\n" +
+                          std::string(bakeHead) + "constexpr const char *bakedWXWIN = " +
+                          cppString(wxwin) + ";\nconstexpr const char *bakedWXCFG = " +
+                          cppString(wxcfg) + ";\n// setup.h when the answers were baked\n" +
+                          "constexpr const char *setupStamp = " + cppString(fileStamp(setuph)) +
+                          ";\nconstexpr uint64_t setupHash = 0x" + toHex(fnv1a(text)) +
+                          "ULL;\n\nconstexpr Answer answers[] = {\n" + answers + "};\n" + bakeMain;
+    if(!writeFileIfChanged(filename, content)) {
+        std::cerr << "Error opening file for writing!" << std::endl;
+        return 1;
+    }
+    std::cout << filename << std::endl;
+    return 0;
+}
+
+// folders inside a folder
+std::vector<std::string> subDirs(const std::string &dir) {
+    std::vector<std::string> names;
+#ifdef _WIN32
+    WIN32_FIND_DATA data;
+    HANDLE find = FindFirstFile((dir + "/*").c_str(), &data);
+    if(find == INVALID_HANDLE_VALUE) return names;
+    do {
+        if(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) names.push_back(data.cFileName);
+    } while(FindNextFile(find, &data));
+    FindClose(find);
+#else
+    DIR *folder = opendir(dir.c_str());
+    if(!folder) return names;
+    while(dirent *entry = readdir(folder)) {
+        struct stat info;
+        if(stat((dir + "/" + entry->d_name).c_str(), &info) == 0 && S_ISDIR(info.st_mode))
+            names.push_back(entry->d_name);
+    }
+    closedir(folder);
+#endif
+    names.erase(std::remove_if(names.begin(), names.end(),
+                               [](const std::string &name) { return name == "." || name == ".."; }),
+                names.end());
+    return names;
+}
+
+// every folder under WXWIN/lib with a wx/setup.h, the way --wxcfg= names it
+// e.g. wx/include/msw-unicode-static-3.2 or vc_x64_lib/mswud
+std::vector<std::string> findConfigs(const std::string &wxwin) {
+    std::vector<std::string> configs;
+    std::function<void(const std::string &, int)> scan = [&](const std::string &cfg, int depth) {
+        std::string dir = wxwin + "/lib" + (cfg == "" ? "" : "/" + cfg);
+        if(cfg != "" && fileExists(dir + "/wx/setup.h")) {
+            configs.push_back(cfg);
+            return;
+        }
+        if(depth == 0) return;
+        for(const std::string &name : subDirs(dir)) {
+            if(name != "wx-flags-cache") scan(cfg == "" ? name : cfg + "/" + name, depth - 1);
+        }
+    };
+    scan("", 4);
+    std::sort(configs.begin(), configs.end());
+    return configs;
+}
+
+// --wxflagsALL answers the same query for every configuration on a pool of threads
+// each query has its own build, everything else goes through files
+int resolveAll(int argc, char *argv[]) {
+    // WXWIN and --prefix= go through the same steps as for a single query, WXCFG isn't needed
+    Build base;
+    createCommand(argc, argv, base);
+    getWXvars(base);
+    if(base.wxwin == "") {
+        std::cerr << "Missing WXWIN. Please specify either the environment variable or use --prefix="
+                  << std::endl;
+        return 1;
+    }
+    if(hasFlag(argc, argv, "--wxflagsNUL")) {
+        std::cerr << "Error: --wxflagsALL can't be combined with --wxflagsNUL" << std::endl;
+        return 1;
+    }
+    std::vector<std::string> configs = findConfigs(base.wxwin);
+    if(configs.empty()) {
+        std::cerr << "Error: No wx/setup.h found under " << base.wxwin << "/lib" << std::endl;
+        return 1;
+    }
+    std::string wxwin = base.wxwin;
+    std::vector<std::string> outputs(configs.size());
+    std::vector<int> statuses(configs.size(), 1);
+    std::atomic<size_t> next(0);
+    auto work = [&] {
+        for(size_t i = next++; i < configs.size(); i = next++) {
+            // the same arguments with this configuration
+            std::vector<std::string> args = {argv[0]};
+            for(int j = 1; j < argc; j++) {
+                std::string arg = argv[j];
+                if(arg != "--wxflagsALL" && arg.rfind("--prefix=", 0) != 0 &&
+                   arg.rfind("--wxcfg=", 0) != 0)
+                    args.push_back(arg);
+            }
+            args.push_back("--prefix=" + wxwin);
+            args.push_back("--wxcfg=" + configs[i]);
+            std::vector<char *> pointers;
+            for(std::string &arg : args) pointers.push_back(&arg[0]);
+            Build build;
+            std::string command = createCommand(pointers.size(), pointers.data(), build);
+            createBuildCfg(build);
+            statuses[i] = cachedQuery(build, pointers.size(), pointers.data(), command, outputs[i]);
+            if(statuses[i] == 0 && wantsResponseFile(argc, argv) &&
+               !toResponseFile(build, flagValue(argc, argv, "--wxflagsRSP="), outputs[i]))
+                statuses[i] = 1;
+        }
+    };
+    size_t count = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), configs.size());
+    std::vector<std::thread> workers;
+    for(size_t i = 1; i < count; i++) workers.emplace_back(work);
+    work();
+    for(std::thread &worker : workers) worker.join();
+
+    int status = 0;
+    bool json = hasFlag(argc, argv, "--wxflagsJSON");
+    size_t width = 5;
+    for(const std::string &cfg : configs) width = std::max(width, cfg.length());
+    std::string temp = json ? "[\n" : "WXCFG" + std::string(width - 5, ' ') + "  STATUS  FLAGS\n";
+    for(size_t i = 0; i < configs.size(); i++) {
+        if(status == 0) status = statuses[i];
+        std::string output = outputs[i];
+        strstrip(output);
+        if(!json) {
+            std::replace(output.begin(), output.end(), '\n', ' ');
+            std::string code = std::to_string(statuses[i]);
+            temp += configs[i] + std::string(width - configs[i].length(), ' ') + "  " + code +
+                    std::string(8 - std::min<size_t>(code.length(), 7), ' ') + output + "\n";
+            continue;
+        }
+        temp += "  {\"wxcfg\": \"" + jsonEscape(configs[i]) +
+                "\", \"status\": " + std::to_string(statuses[i]) + ", ";
+        // the categories of --wxflagsJSON become fields of the configuration
+        if(output.length() > 2 && output[0] == '{') {
+            temp += output.substr(1);
+        } else {
+            temp += "\"output\": \"" + jsonEscape(output) + "\"}";
+        }
+        temp += i + 1 < configs.size() ? ",\n" : "\n";
+    }
+    if(json) temp += "]\n";
+    std::cout << temp;
+    return status;
+}
+
+// --wxflagsSERVE keeps answers in memory, regular calls ask the server first
+// and do the work themselves if there is none
+
+#ifdef _WIN32
+typedef HANDLE Connection;
+#else
+typedef int Connection;
+#endif
+
+#ifndef _WIN32
+// a folder only this user can get into, so nobody else can put a socket there
+bool isPrivateDir(const std::string &dir) {
+    struct stat info;
+    return lstat(dir.c_str(), &info) == 0 && S_ISDIR(info.st_mode) && info.st_uid == getuid() &&
+           (info.st_mode & 077) == 0;
+}
+#endif
+
+// where the server listens, WXFLAGS_SOCKET can point somewhere else
+// the default is only this user's, "" if there is no such place
+std::string serverAddress(bool create = false) {
+    const char *address = getenv("WXFLAGS_SOCKET");
+    if(address && *address) return address;
+#ifdef _WIN32
+    // one pipe per user, the peers check each other's user anyway
+    char user[256];
+    DWORD size = sizeof(user);
+    if(!GetUserName(user, &size)) return "";
+    return std::string("\\\\.\\pipe\\wx-flags-") + user;
+#else
+    // $XDG_RUNTIME_DIR is the user's own, /tmp is everyone's so it gets a folder of the user's
+    const char *runtime = getenv("XDG_RUNTIME_DIR");
+    std::string dir = runtime && *runtime ? runtime : "/tmp/wx-flags-" + std::to_string(getuid());
+    if(create && !(runtime && *runtime)) mkdir(dir.c_str(), 0700);
+    if(!isPrivateDir(dir)) return "";
+    return dir + "/wx-flags.sock";
+#endif
+}
+
+#ifdef _WIN32
+// the SID of the user a process runs as, empty if it can't be read
+std::string processUser(HANDLE process) {
+    HANDLE token;
+    std::string user;
+    if(!process || !OpenProcessToken(process, TOKEN_QUERY, &token)) return user;
+    DWORD size = 0;
+    GetTokenInformation(token, TokenUser, NULL, 0, &size);
+    std::vector<char> buffer(size);
+    if(size > 0 && GetTokenInformation(token, TokenUser, buffer.data(), size, &size)) {
+        PSID sid = reinterpret_cast<TOKEN_USER *>(buffer.data())->User.Sid;
+        user.assign(static_cast<const char *>(sid), GetLengthSid(sid));
+    }
+    CloseHandle(token);
+    return user;
+}
+#endif
+
+bool connectionRead(Connection connection, char *buffer, size_t size, size_t &bytesRead) {
+#ifdef _WIN32
+    // server pipes are overlapped, this works for both kinds
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    DWORD read = 0;
+    bool success = ReadFile(connection, buffer, size, NULL, &overlapped) ||
+                   GetLastError() == ERROR_IO_PENDING;
+    success = success && GetOverlappedResult(connection, &overlapped, &read, TRUE);
+    CloseHandle(overlapped.hEvent);
+    bytesRead = read;
+    return success && read > 0;
+#else
+    ssize_t read = ::read(connection, buffer, size);
+    bytesRead = read > 0 ? read : 0;
+    return read > 0;
+#endif
+}
+
+bool connectionWrite(Connection connection, const std::string &data) {
+    size_t written = 0;
+    while(written < data.length()) {
+#ifdef _WIN32
+        OVERLAPPED overlapped = {};
+        overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+        DWORD chunk = 0;
+        bool success = WriteFile(connection, data.c_str() + written, data.length() - written, NULL,
+                                 &overlapped) ||
+                       GetLastError() == ERROR_IO_PENDING;
+        success = success && GetOverlappedResult(connection, &overlapped, &chunk, TRUE);
+        CloseHandle(overlapped.hEvent);
+        if(!success) return false;
+#else
+        ssize_t chunk = write(connection, data.c_str() + written, data.length() - written);
+        if(chunk <= 0) return false;
+#endif
+        written += chunk;
+    }
+    return true;
+}
+
+void connectionClose(Connection connection) {
+#ifdef _WIN32
+    CloseHandle(connection);
+#else
+    close(connection);
+#endif
+}
+
+// the other end runs as this user, the client checks the server and the server the client
+bool isSameUser(Connection connection, bool peerIsServer) {
+#ifdef _WIN32
+    ULONG pid = 0;
+    if(!(peerIsServer ? GetNamedPipeServerProcessId(connection, &pid)
+                      : GetNamedPipeClientProcessId(connection, &pid)))
+        return false;
+    HANDLE peer = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    std::string user = processUser(peer);
+    if(peer) CloseHandle(peer);
+    return user != "" && user == processUser(GetCurrentProcess());
+#else
+    (void)peerIsServer;
+    ucred peer;
+    socklen_t size = sizeof(peer);
+    return getsockopt(connection, SOL_SOCKET, SO_PEERCRED, &peer, &size) == 0 &&
+           peer.uid == getuid();
+#endif
+}
+
+// a path that means the same from any folder
+std::string absolutePath(const std::string &path) {
+#ifdef _WIN32
+    char full[MAX_PATH];
+    DWORD length = path == "" ? 0 : GetFullPathName(path.c_str(), MAX_PATH, full, NULL);
+    return length > 0 && length < MAX_PATH ? std::string(full, length) : path;
+#else
+    if(path == "" || path[0] == '/') return path;
+    char *cwd = getcwd(NULL, 0);
+    std::string dir = cwd ? cwd : "";
+    free(cwd);
+    return dir == "" ? path : dir + "/" + path;
+#endif
+}
+
+// what the client's wx-config and compiler would see, the server answers with its client's
+const char *const clientVariables[] = {"PATH", "CXX", "WXWIN", "WXCFG"};
+
+// the number of fields, WXWIN, WXCFG, the number of variables, the client's variables and the
+// arguments, all NUL terminated, each variable is NAME=value or just NAME if it isn't set
+// the server runs in another folder, so WXWIN and --prefix= are sent as absolute paths
+std::string encodeRequest(const Build &build, int argc, char *argv[]) {
+    size_t variables = sizeof(clientVariables) / sizeof(clientVariables[0]);
+    std::string request = std::to_string(argc + 2 + variables);
+    request.push_back('\0');
+    request += absolutePath(build.wxwin);
+    request.push_back('\0');
+    request += build.wxcfg;
+    request.push_back('\0');
+    request += std::to_string(variables);
+    request.push_back('\0');
+    for(const char *name : clientVariables) {
+        const char *value = getenv(name);
+        request += name;
+        if(value) request += "=" + (strcmp(name, "WXWIN") == 0 ? absolutePath(value) : value);
+        request.push_back('\0');
+    }
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg.rfind("--prefix=", 0) == 0) arg = "--prefix=" + absolutePath(arg.substr(9));
+        request += arg;
+        request.push_back('\0');
+    }
+    return request;
+}
+
+// false until the whole request has arrived
+bool decodeRequest(const std::string &request, std::vector<std::string> &fields) {
+    fields.clear();
+    size_t pos = 0, end, count = 0;
+    while((end = request.find('\0', pos)) != std::string::npos) {
+        if(pos == 0) {
+            count = atoi(request.c_str());
+        } else {
+            fields.push_back(request.substr(pos, end - pos));
+        }
+        pos = end + 1;
+        if(count > 0 && fields.size() == count) return true;
+    }
+    return false;
+}
+
+// only plain queries are answered by the server
+bool isServable(int argc, char *argv[]) {
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg.rfind("--wxflags", 0) == 0 && arg != "--wxflagsDYNAMIC" &&
+           arg != "--wxflagsCUSTOM" && arg != "--wxflagsNATIVE" && arg != "--wxflagsJSON" &&
+           arg != "--wxflagsNUL" && arg != "--wxflagsRSP" && arg != "--wxflagsORDER" &&
+           arg != "--wxflagsCANONICAL" && arg != "--wxflagsHASH" &&
+           arg.rfind("--wxflagsRSP=", 0) != 0 && arg.rfind("--wxflagsBASE=", 0) != 0 &&
+           arg.rfind("--wxflagsTRACE", 0) != 0)
+            return false;
+    }
+    return true;
+}
+
+// ask a running server, false if there is none or it couldn't answer
+// what the query wrote to stderr on the server is written to stderr here
+bool askServer(const Build &build, int argc, char *argv[], std::string &output, int &status) {
+    std::string address = serverAddress(), response;
+    if(address == "") return false;
+#ifdef _WIN32
+    HANDLE connection = CreateFile(address.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL,
+                                   OPEN_EXISTING, 0, NULL);
+    if(connection == INVALID_HANDLE_VALUE) return false;
+#else
+    int connection = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(connection < 0) return false;
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, address.c_str(), sizeof(addr.sun_path) - 1);
+    if(connect(connection, (sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(connection);
+        return false;
+    }
+#endif
+    // an answer is only taken from a server of the same user
+    bool success = isSameUser(connection, true) &&
+                   connectionWrite(connection, encodeRequest(build, argc, argv));
+    char buffer[4096];
+    size_t bytesRead;
+    // the server closes the connection after the answer
+    while(success && connectionRead(connection, buffer, sizeof(buffer), bytesRead))
+        response.append(buffer, bytesRead);
+    connectionClose(connection);
+    // the exit status of wx-config comes first, then the errors
+    size_t end = response.find('\0'), errors = end == std::string::npos
+                                                  ? std::string::npos
+                                                  : response.find('\0', end + 1);
+    if(!success || end == 0 || errors == std::string::npos) return false;
+    status = atoi(response.c_str());
+    std::cerr << response.substr(end + 1, errors - end - 1);
+    output = response.substr(errors + 1);
+    return true;
+}
+
+// answers by query, dropped whenever a watched folder changes, which starts a new generation
+// connections are answered on threads of their own, the lock guards all of it
+std::map<std::string, std::string> serverResults;
+std::set<std::string> watchedDirs;
+unsigned long serverGeneration = 0;
+std::mutex serverLock;
+
+void invalidateServer() {
+    std::lock_guard<std::mutex> lock(serverLock);
+    serverResults.clear();
+    serverGeneration++;
+    forgetSetupModels();
+}
+
+// false if there is no answer yet
+bool serverResult(const std::string &query, std::string &output) {
+    std::lock_guard<std::mutex> lock(serverLock);
+    std::map<std::string, std::string>::iterator found = serverResults.find(query);
+    if(found == serverResults.end()) return false;
+    output = found->second;
+    return true;
+}
+
+// answer a request the same way a separate run in the client's environment would
+int answerRequest(const std::vector<std::string> &fields, std::vector<std::string> &newDirs,
+                  std::string &output) {
+    size_t variables = atoi(fields[2].c_str());
+    Build build;
+    if(fields[0] != "" && fields[1] != "") {
+        build.wxwin = fields[0];
+        build.wxcfg = fields[1];
+    }
+    build.environment.assign(fields.begin() + 3, fields.begin() + 3 + variables);
+    std::vector<std::string> args(1, "wx-flags");
+    args.insert(args.end(), fields.begin() + 3 + variables, fields.end());
+    std::vector<char *> argv;
+    for(std::string &arg : args) argv.push_back(&arg[0]);
+    int argc = argv.size();
+    argv.push_back(NULL);
+
+    std::string command = createCommand(argc, argv.data(), build);
+    fixWXvars(build);
+    createBuildCfg(build);
+    if(build.wxwin == "" || build.wxcfg == "")
+        return runQuery(build, argc, argv.data(), command, output);
+    std::string query = cacheQuery(build, argc, argv.data());
+    {
+        std::lock_guard<std::mutex> lock(serverLock);
+        // setup.h is one folder deeper than build.cfg
+        std::vector<std::string> watches = {cfgDir(build), cfgDir(build) + "/wx"};
+        // and the archives for the answers that come from them
+        if(readsArchives(argc, argv.data())) watches.push_back(build.wxwin + "/lib");
+        for(const std::string &watch : watches) {
+            if(watchedDirs.insert(watch).second) newDirs.push_back(watch);
+        }
+    }
+    if(serverResult(query, output)) return 0;
+    // the same query from other clients waits for this one and takes its answer
+    createDir(cacheDir(build));
+    FileLock flight(cacheDir(build) + "/" + toHex(fnv1a(query)) + ".lock", build.timeout);
+    if(serverResult(query, output)) return 0;
+    unsigned long generation;
+    {
+        std::lock_guard<std::mutex> lock(serverLock);
+        generation = serverGeneration;
+    }
+    int status = runQuery(build, argc, argv.data(), command, output);
+    // don't remember failures, or answers from before a watched folder changed
+    std::lock_guard<std::mutex> lock(serverLock);
+    if(status == 0 && generation == serverGeneration) serverResults[query] = output;
+    return status;
+}
+
+// std::cerr of the server, a thread answering a request writes to its client's errors
+struct ServerErrors : std::streambuf {
+    std::streambuf *stderrBuffer;
+
+    explicit ServerErrors(std::streambuf *stderrBuffer) : stderrBuffer(stderrBuffer) {}
+    std::streamsize xsputn(const char *data, std::streamsize size) override {
+        if(!requestErrors) return stderrBuffer->sputn(data, size);
+        requestErrors->append(data, size);
+        return size;
+    }
+    int_type overflow(int_type c) override {
+        if(traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+        char ch = traits_type::to_char_type(c);
+        return xsputn(&ch, 1) == 1 ? c : traits_type::eof();
+    }
+    int sync() override { return requestErrors ? 0 : stderrBuffer->pubsync(); }
+};
+
+// the exit status, the errors and the output of a request, NUL separated
+std::string handleRequest(const std::vector<std::string> &fields,
+                          std::vector<std::string> &newDirs) {
+    std::string errors, output;
+    requestErrors = &errors;
+    int status = answerRequest(fields, newDirs, output);
+    requestErrors = nullptr;
+    std::string response = std::to_string(status);
+    response.push_back('\0');
+    response += errors;
+    response.push_back('\0');
+    return response + output;
+}
+
+// read a request and answer it
+void serveConnection(Connection connection, std::vector<std::string> &newDirs) {
+    // only this user's runs are answered
+    if(!isSameUser(connection, false)) return;
+    std::string request;
+    std::vector<std::string> fields;
+    char buffer[4096];
+    size_t bytesRead;
+    while(!decodeRequest(request, fields) &&
+          connectionRead(connection, buffer, sizeof(buffer), bytesRead))
+        request.append(buffer, bytesRead);
+    if(decodeRequest(request, fields) && fields.size() >= 3 &&
+       fields.size() >= 3 + (size_t)atoi(fields[2].c_str()))
+        connectionWrite(connection, handleRequest(fields, newDirs));
+}
+
+int serve() {
+    std::string address = serverAddress(true);
+    if(address == "") {
+        std::cerr << "Error: No folder of this user to listen in, set XDG_RUNTIME_DIR or "
+                     "WXFLAGS_SOCKET"
+                  << std::endl;
+        return 1;
+    }
+    static ServerErrors errors(std::cerr.rdbuf());
+    std::cerr.rdbuf(&errors);
+#ifdef _WIN32
+    // the threads hand the folders to watch to the loop, which waits on the changes
+    std::vector<HANDLE> watches;
+    std::vector<std::string> pendingDirs;
+    std::mutex pendingLock;
+    HANDLE wake = CreateEvent(NULL, FALSE, FALSE, NULL);
+    while(true) {
+        HANDLE pipe = CreateNamedPipe(address.c_str(), PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED,
+                                      PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT |
+                                          PIPE_REJECT_REMOTE_CLIENTS,
+                                      PIPE_UNLIMITED_INSTANCES, 65536, 65536, 0, NULL);
+        if(pipe == INVALID_HANDLE_VALUE) {
+            std::cerr << "Error: Could not create pipe " << address << std::endl;
+            return 1;
+        }
+        OVERLAPPED overlapped = {};
+        overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+        if(!ConnectNamedPipe(pipe, &overlapped) && GetLastError() == ERROR_PIPE_CONNECTED)
+            SetEvent(overlapped.hEvent);
+        // wait for a client, dropping answers whenever a watched folder changes
+        while(true) {
+            std::vector<HANDLE> handles = {overlapped.hEvent, wake};
+            handles.insert(handles.end(), watches.begin(), watches.end());
+            DWORD index = WaitForMultipleObjects(handles.size(), handles.data(), FALSE, INFINITE) -
+                          WAIT_OBJECT_0;
+            if(index == 0) break;
+            if(index >= handles.size()) return 1;
+            if(index == 1) {
+                std::lock_guard<std::mutex> lock(pendingLock);
+                for(const std::string &dir : pendingDirs) {
+                    HANDLE watch = FindFirstChangeNotification(
+                        dir.c_str(), FALSE,
+                        FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE |
+                            FILE_NOTIFY_CHANGE_LAST_WRITE);
+                    if(watch != INVALID_HANDLE_VALUE && watches.size() < MAXIMUM_WAIT_OBJECTS - 2)
+                        watches.push_back(watch);
+                }
+                pendingDirs.clear();
+                continue;
+            }
+            invalidateServer();
+            FindNextChangeNotification(handles[index]);
+        }
+        CloseHandle(overlapped.hEvent);
+        // the next client gets a new pipe while this one is answered
+        std::thread([&, pipe] {
+            std::vector<std::string> newDirs;
+            serveConnection(pipe, newDirs);
+            FlushFileBuffers(pipe);
+            DisconnectNamedPipe(pipe);
+            CloseHandle(pipe);
+            if(newDirs.empty()) return;
+            std::lock_guard<std::mutex> lock(pendingLock);
+            pendingDirs.insert(pendingDirs.end(), newDirs.begin(), newDirs.end());
+            SetEvent(wake);
+        }).detach();
+    }
+#else
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, address.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(address.c_str());
+    if(listener < 0 || bind(listener, (sockaddr *)&addr, sizeof(addr)) < 0 ||
+       listen(listener, SOMAXCONN) < 0) {
+        std::cerr << "Error: Could not listen on " << address << std::endl;
+        return 1;
+    }
+    int watcher = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    while(true) {
+        pollfd fds[2] = {{listener, POLLIN, 0}, {watcher, POLLIN, 0}};
+        if(poll(fds, watcher < 0 ? 1 : 2, -1) < 0) continue;
+        // drop answers whenever a watched folder changes
+        if(fds[1].revents & POLLIN) {
+            char events[4096];
+            while(read(watcher, events, sizeof(events)) > 0) {
+            }
+            invalidateServer();
+        }
+        if(fds[0].revents & POLLIN) {
+            int connection = accept4(listener, NULL, NULL, SOCK_CLOEXEC);
+            if(connection < 0) continue;
+            // each client is answered on its own thread, so none waits behind another's wx-config
+            std::thread([watcher, connection] {
+                std::vector<std::string> newDirs;
+                serveConnection(connection, newDirs);
+                close(connection);
+                for(const std::string &dir : newDirs) {
+                    inotify_add_watch(watcher, dir.c_str(),
+                                      IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE |
+                                          IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO);
+                }
+            }).detach();
+        }
+    }
+#endif
+}
+
+std::shared_ptr<const Result> Resolver::query(const Config &config,
+                                              const std::vector<Category> &categories) {
+    TraceScope trace("query");
+    Build build;
+    build.wxwin = config.wxwin;
+    build.wxcfg = config.wxcfg;
+    if(!getWXvars(build)) {
+        std::shared_ptr<Result> missing = std::make_shared<Result>();
+        missing->status = 1;
+        return missing;
+    }
+    // the same arguments the command line would get
+    std::vector<std::string> args = {"wx-flags"};
+    for(Category category : categories)
+        args.push_back(std::string("--") + categoryName(category));
+    if(config.custom) args.push_back("--wxflagsCUSTOM");
+    if(config.native) args.push_back("--wxflagsNATIVE");
+    std::string key = build.wxwin + "\n" + build.wxcfg;
+    for(size_t i = 1; i < args.size(); i++) key += "\n" + args[i];
+
+    std::vector<char *> pointers;
+    for(std::string &arg : args) pointers.push_back(&arg[0]);
+
+    createBuildCfg(build);
+    std::string stamps = cacheStamps(build, pointers.size(), pointers.data());
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        std::map<std::string, Entry>::iterator found = memo.find(key);
+        if(found != memo.end() && found->second.stamps == stamps) return found->second.result;
+    }
+    std::string command = createCommand(pointers.size(), pointers.data(), build);
+    std::map<Category, std::string> sections;
+    std::shared_ptr<Result> result = std::make_shared<Result>();
+    result->status = resolveSections(build, pointers.size(), pointers.data(), command, categories,
+                                     config.native, sections);
+    // moved, not copied, in the order of Category
+    std::string *fields[] = {&result->cflags, &result->rcflags, &result->libs};
+    for(std::pair<const Category, std::string> &section : sections) {
+        strstrip(section.second);
+        *fields[section.first] = std::move(section.second);
+    }
+    // failures are tried again next time
+    if(result->status != 0) return result;
+    std::lock_guard<std::mutex> guard(lock);
+    memo[key] = Entry{stamps, result};
+    return result;
+}
+
+void Resolver::clear() {
+    std::lock_guard<std::mutex> guard(lock);
+    memo.clear();
+}
+
+int runCommand(int argc, char **argv) {
+    if(hasFlag(argc, argv, "--wxflagsSERVE")) return serve();
+
+    // create the wx-config command, the build comes from it or from the environment
+    Build build;
+    std::string command = createCommand(argc, argv, build);
+    bool known = getWXvars(build);
+
+    // a running server already knows the answer
+    std::string output;
+    int status = 0;
+    if(isServable(argc, argv) && askServer(build, argc, argv, output, status))
+        return printOutput(build, argc, argv, output, status);
+
+    if(hasFlag(argc, argv, "--wxflagsALL")) return resolveAll(argc, argv);
+
+    // build.cfg is brought up to date by the queries, while wx-config runs
+    if(hasFlag(argc, argv, "--wxflagsVERIFY")) {
+        if(!known) return 1;
+        return verifyNative(build, argc, argv, command);
+    }
+
+    if(hasFlag(argc, argv, "--wxflagsCACHESTATS")) {
+        if(!known) return 1;
+        printCacheStats(build);
+        return 0;
+    }
+
+    if(flagValue(argc, argv, "--wxflagsEXPORT=") != "")
+        return exportFlags(build, argc, argv, command);
+
+    if(flagValue(argc, argv, "--wxflagsPCH=") != "") {
+        if(!known) return 1;
+        return precompiledHeader(build, argc, argv);
+    }
+
+    if(flagValue(argc, argv, "--wxflagsBAKE=") != "") {
+        if(!known) return 1;
+        return bake(build, argc, argv);
+    }
+
+    status = cachedQuery(build, argc, argv, command, output);
+    return printOutput(build, argc, argv, output, status);
+}
+
+int run(int argc, char **argv) {
+    startTrace(argc, argv);
+    int status;
+    {
+        TraceScope trace("main");
+        status = runCommand(argc, argv);
+    }
+    finishTrace();
+    return status;
+}
+
+} // namespace wxflags
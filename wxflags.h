@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Name:        wxflags.h
+// Purpose:     resolve the flags of static wxWidgets libraries on Windows without starting wx-flags
+// Author:      archivesilver
+// Created:     2024-08-18
+// Copyright:   (c) archivesilver
+// Licence:     wxWidgets licence
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef WXFLAGS_H
+#define WXFLAGS_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace wxflags {
+
+enum Category { CFLAGS, RCFLAGS, LIBS };
+
+// a wxWidgets build, what --prefix= and --wxcfg= are on the command line
+// empty fields come from the WXWIN and WXCFG environment variables
+struct Config {
+    std::string wxwin, wxcfg;
+    bool custom = false; // --wxflagsCUSTOM
+    bool native = false; // --wxflagsNATIVE, no wx-config at all
+};
+
+// the flags of the categories a query asked for, the others stay empty
+struct Result {
+    int status = 0; // exit status of wx-config
+    std::string cflags, rcflags, libs;
+};
+
+// resolves flags the way the wx-flags command does, without starting it
+// any number of threads can share one, answers are remembered until setup.h, build.cfg or
+// wx-config change, and are shared rather than copied
+class Resolver {
+  public:
+    std::shared_ptr<const Result> query(const Config &config,
+                                        const std::vector<Category> &categories);
+    // forget every remembered answer
+    void clear();
+
+  private:
+    struct Entry {
+        std::string stamps;
+        std::shared_ptr<const Result> result;
+    };
+    std::mutex lock;
+    std::map<std::string, Entry> memo;
+};
+
+// the wx-flags command, argc and argv as main() gets them
+int run(int argc, char **argv);
+
+} // namespace wxflags
+
+#endif
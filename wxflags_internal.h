@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Name:        wxflags_internal.h
+// Purpose:     the stages of a wx-flags run, for the benchmarks in bench, not a stable API
+// Author:      archivesilver
+// Created:     2024-08-18
+// Copyright:   (c) archivesilver
+// Licence:     wxWidgets licence
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef WXFLAGS_INTERNAL_H
+#define WXFLAGS_INTERNAL_H
+
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wxflags {
+
+// the wxWidgets build a query is about, passed to everything that reads its files
+// so --wxflagsALL, the server and the library can work on several builds side by side
+struct Build {
+    std::string wxwin, wxcfg; // WXWIN and WXCFG, or --prefix= and --wxcfg=
+    int timeout = 30000;      // milliseconds, --wxflagsTIMEOUT= sets it in seconds
+    // NAME=value, or NAME for unset, over this process's own, the server's client's variables
+    std::vector<std::string> environment;
+};
+
+// what a child process left behind
+struct ProcessResult {
+    int exitCode = -1; // -1 if it couldn't be started
+    bool timedOut = false;
+    std::string errors; // stderr, kept apart from the output
+};
+
+// files and folders
+void createDir(const std::string &dir);
+bool readFile(const std::string &filename, std::string &content);
+bool writeFileAtomic(const std::string &filename, const std::string &content);
+bool writeFileIfChanged(const std::string &filename, const std::string &content);
+std::string slashes(std::string str);
+std::string cfgDir(const Build &build);
+std::string cacheDir(const Build &build);
+
+// setup.h and build.cfg
+std::vector<std::string> setupOptionNames();
+void forgetSetupModels();
+std::string wxVersion(const Build &build);
+bool createBuildCfg(const Build &build, bool checkCompiler = false);
+
+// running wx-config and rewriting what it prints
+ProcessResult runProcess(const std::string &command,
+                         const std::function<void(std::string_view)> &onOutput, int timeout,
+                         const std::function<void()> &onStarted = nullptr,
+                         const std::vector<std::string> &environment = {});
+std::string wxconfig(const Build &build, const std::string &command, int &status);
+std::string fixInclude(std::string_view str);
+std::string fixLibNames(std::string_view str, const std::string &version);
+std::string fixLibs(std::string_view str, const std::string &libs, const std::string &version);
+std::string fixLibs(const Build &build, std::string_view str, bool custom);
+std::string addSetupHLibs(const Build &build);
+
+// include folders and header maps
+std::string minimizeIncludes(const std::string &flags);
+std::map<std::string, std::string> wxHeaders(const std::string &flags);
+std::string headerMap(const std::map<std::string, std::string> &headers);
+
+} // namespace wxflags
+
+#endif